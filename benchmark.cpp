@@ -0,0 +1,460 @@
+// Benchmark suite: times load, search, sort, export and cleanup for every data structure
+// and payment channel over datasets of increasing size, and writes the results as CSV and
+// JSON so runs of different builds can be diffed.
+//
+// Build: g++ -std=c++17 -O2 -pthread benchmark.cpp -o fraud_bench
+// Run:   ./fraud_bench --input=financial_fraud_detection_dataset.csv --sizes=10K,100K,1M,10M
+//        ./fraud_bench --generate --seed=7 --sizes=1M,10M   (synthetic, reproducible datasets)
+
+#define FRAUD_NO_MAIN
+#include "main.cpp"
+
+namespace Benchmark {
+    const int MAX_SIZES = 16;
+
+    struct Options
+    {
+        string input;
+        string workDir;
+        string csvPath;
+        string jsonPath;
+        string type;
+        long long sizes[MAX_SIZES];
+        int sizeCount;
+        int loadRuns; // Load/cleanup cycles per dataset and data structure
+        bool list;
+        bool array;
+        bool columnar;
+        bool exportResults;
+        bool generate; // Synthetic datasets instead of cutting them from the input
+        Generator::Config generator;
+        Options()
+            : input(datasetPath), workDir("."), csvPath("bench_results.csv"), jsonPath("bench_results.json"),
+              type("transfer"), sizeCount(0), loadRuns(1), list(true), array(true), columnar(true), exportResults(true),
+              generate(false) {}
+    };
+
+    // One line of the results table
+    struct Result
+    {
+        long long datasetRows;
+        string dataStructure;
+        string channel; // "all" for load and cleanup
+        string operation;
+        long long rows; // Rows the operation works on
+        size_t bytes;   // Memory held by those rows
+        Timing::Stats timing;
+        Result() : datasetRows(0), rows(0), bytes(0) {}
+        double rowsPerSecond() const { return timing.medianNs > 0 ? rows / (timing.medianNs / 1e9) : 0.0; }
+        double bytesPerRow() const { return rows > 0 ? static_cast<double>(bytes) / rows : 0.0; }
+    };
+
+    // Growable list of results, in the order they were measured
+    class Results
+    {
+    public:
+        Results() : items(nullptr), count(0), capacity(0) {}
+        ~Results() { delete[] items; }
+
+        void add(const Result &result)
+        {
+            if (count == capacity)
+            {
+                int newCapacity = capacity == 0 ? 64 : capacity * 2;
+                Result *grown = new Result[newCapacity];
+                for (int i = 0; i < count; ++i) grown[i] = items[i];
+                delete[] items;
+                items = grown;
+                capacity = newCapacity;
+            }
+            items[count++] = result;
+        }
+
+        int size() const { return count; }
+        const Result &operator[](int i) const { return items[i]; }
+
+    private:
+        Result *items;
+        int count;
+        int capacity;
+
+        Results(const Results &);
+        Results &operator=(const Results &);
+    };
+
+    inline long long elapsedNs(chrono::steady_clock::time_point start)
+    {
+        return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+    }
+
+    void record(Results &results, long long datasetRows, const string &dataStructure, const string &channel,
+                const string &operation, long long rows, size_t bytes, const Timing::Stats &timing)
+    {
+        Result result;
+        result.datasetRows = datasetRows;
+        result.dataStructure = dataStructure;
+        result.channel = channel;
+        result.operation = operation;
+        result.rows = rows;
+        result.bytes = bytes;
+        result.timing = timing;
+        results.add(result);
+        cerr << "  " << dataStructure << " " << channel << " " << operation << ": "
+             << Timing::format(timing.medianNs) << " (" << rows << " rows)" << endl;
+    }
+
+    // Load/cleanup samples of one data structure, summarized once all cycles have run
+    struct Cycles
+    {
+        long long *loadNs;
+        long long *cleanupNs;
+        long long rows;
+        size_t bytes;
+        explicit Cycles(int runs) : loadNs(new long long[runs]), cleanupNs(new long long[runs]), rows(0), bytes(0) {}
+        ~Cycles()
+        {
+            delete[] loadNs;
+            delete[] cleanupNs;
+        }
+    };
+
+    void recordCycles(Results &results, const Options &options, long long datasetRows, const string &dataStructure,
+                      Cycles &cycles)
+    {
+        record(results, datasetRows, dataStructure, "all", "load", cycles.rows, cycles.bytes,
+               Timing::summarize(cycles.loadNs, options.loadRuns, 0));
+        record(results, datasetRows, dataStructure, "all", "cleanup", cycles.rows, cycles.bytes,
+               Timing::summarize(cycles.cleanupNs, options.loadRuns, 0));
+    }
+
+    // --- PER DATA STRUCTURE RUNS ---
+    // Name of a payment channel code, as it appears in the data
+    string channelName(int code)
+    {
+        return Categories::name(Categories::PAYMENT_CHANNEL, static_cast<Categories::Code>(code));
+    }
+
+    // Memory of all channels together
+    template <typename Channels>
+    size_t totalBytes(const Channels &channels)
+    {
+        size_t bytes = 0;
+        for (int c = 0; c < channels.size(); ++c) bytes += channels[c].memory.total();
+        return bytes;
+    }
+
+    // Each cycle loads the dataset and frees it again; the channel operations run on the
+    // last cycle's data, so cleanup is measured after they have sorted it.
+
+    template <typename Backend>
+    bool benchmarkBackend(const Options &options, long long datasetRows, Results &results)
+    {
+        const string name = Backend::name();
+        Cycles cycles(options.loadRuns);
+        for (int cycle = 0; cycle < options.loadRuns; ++cycle)
+        {
+            typename Backend::Channels channels;
+            CsvLoader::LoadStats stats;
+            auto start = chrono::steady_clock::now();
+            if (!Backend::load(datasetPath, channels, stats)) return false;
+            cycles.loadNs[cycle] = elapsedNs(start);
+            cycles.rows = stats.rows;
+            cycles.bytes = totalBytes(channels);
+
+            for (int c = 0; cycle == options.loadRuns - 1 && c < channels.size(); ++c)
+            {
+                typename Backend::Channel &channel = channels[c];
+                long long rows = Backend::rows(channel);
+                if (rows == 0) continue;
+
+                typename Backend::MatchSet matches;
+                Timing::Stats search = Backends::timeSearch<Backend>(channel, options.type, matches);
+                record(results, datasetRows, name, channelName(c), "search", rows, channel.memory.total(), search);
+
+                Timing::Stats sort = Backends::timeSort<Backend>(channel);
+                record(results, datasetRows, name, channelName(c), "sort", rows, channel.memory.total(), sort);
+
+                if (!options.exportResults) continue;
+                // Both result files the menus write: the search matches and the sorted rows. The
+                // sort moved the rows, so the matches are looked up again first.
+                matches = Backend::search(channel, options.type);
+                Timing::Stats exported = Timing::measure([](int) {}, [&]() {
+                    Backend::exportSearch(channel, matches, options.type, search);
+                    Backend::exportSort(channel, sort);
+                });
+                record(results, datasetRows, name, channelName(c), "export", rows, channel.memory.total(), exported);
+            }
+
+            start = chrono::steady_clock::now();
+            Backend::cleanup(channels);
+            cycles.cleanupNs[cycle] = elapsedNs(start);
+        }
+        recordCycles(results, options, datasetRows, name, cycles);
+        return true;
+    }
+
+    // --- DATASETS ---
+
+    // Write workDir/bench_<rows>.csv: synthetic rows from the generator, or the header and
+    // the first rows data lines of the input. Returns false when the input cannot be read
+    // or has fewer rows.
+    bool prepareDataset(const Options &options, long long rows, string &path)
+    {
+        path = options.workDir + "/bench_" + to_string(rows) + ".csv";
+        if (options.generate)
+        {
+            Generator::Config config = options.generator;
+            config.rows = rows;
+            Generator::Stats stats;
+            if (!Generator::generate(config, path, stats)) return false;
+            Generator::printStats(stats, path);
+            return true;
+        }
+
+        ifstream in(options.input, ios::binary);
+        if (!in)
+        {
+            cerr << "Cannot open " << options.input << endl;
+            return false;
+        }
+        ofstream out(path, ios::binary);
+        if (!out)
+        {
+            cerr << "Cannot write " << path << endl;
+            return false;
+        }
+        string line;
+        if (!getline(in, line)) return false;
+        out << line << '\n';
+        long long written = 0;
+        while (written < rows && getline(in, line))
+        {
+            if (line.empty()) continue;
+            out << line << '\n';
+            ++written;
+        }
+        out.close();
+        if (written < rows)
+        {
+            cerr << "Skipping " << rows << " rows: " << options.input << " has only " << written << endl;
+            remove(path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    // --- RESULTS ---
+
+    void writeCsv(const string &path, const Results &results)
+    {
+        ofstream out(path);
+        if (!out)
+        {
+            cerr << "Cannot write " << path << endl;
+            return;
+        }
+        out << "dataset_rows,data_structure,channel,operation,rows,runs,median_ns,min_ns,p95_ns,p99_ns,mean_ns,"
+               "stddev_ns,rows_per_sec,bytes_per_row\n";
+        out << fixed;
+        for (int i = 0; i < results.size(); ++i)
+        {
+            const Result &r = results[i];
+            out << r.datasetRows << ',' << r.dataStructure << ',' << r.channel << ',' << r.operation << ','
+                << r.rows << ',' << r.timing.runs << setprecision(0) << ',' << r.timing.medianNs << ','
+                << r.timing.minNs << ',' << r.timing.p95Ns << ',' << r.timing.p99Ns << ',' << r.timing.meanNs << ','
+                << r.timing.stddevNs << ',' << r.rowsPerSecond() << setprecision(1) << ',' << r.bytesPerRow() << '\n';
+        }
+    }
+
+    void writeJson(const string &path, const Options &options, const Results &results)
+    {
+        JsonOutput::Writer out(path.c_str());
+        out.beginObject();
+        out.field("input", options.input);
+        out.field("search_type", options.type);
+        out.field("warmup_runs", static_cast<int>(Timing::warmupRuns));
+        out.field("measured_runs", static_cast<int>(Timing::measuredRuns));
+        out.field("load_runs", options.loadRuns);
+        out.field("load_threads", static_cast<int>(CsvLoader::loadThreads));
+        out.field("sort_threads", static_cast<int>(DynamicArray::sortThreads));
+        out.field("snapshots", CsvLoader::useSnapshots);
+        out.key("results");
+        out.beginArray();
+        for (int i = 0; i < results.size(); ++i)
+        {
+            const Result &r = results[i];
+            out.beginObject();
+            out.field("dataset_rows", r.datasetRows);
+            out.field("data_structure", r.dataStructure);
+            out.field("channel", r.channel);
+            out.field("operation", r.operation);
+            out.field("rows", r.rows);
+            out.field("bytes", r.bytes);
+            out.field("rows_per_sec", r.rowsPerSecond());
+            out.field("bytes_per_row", r.bytesPerRow());
+            Timing::writeJson(out, r.timing);
+            out.endObject();
+        }
+        out.endArray();
+        out.endObject();
+    }
+
+    // Summary table on stdout
+    void printTable(const Results &results)
+    {
+        cout << left << setw(10) << "dataset" << setw(10) << "ds" << setw(15) << "channel" << setw(9) << "op"
+             << right << setw(14) << "median" << setw(16) << "rows/s" << setw(12) << "bytes/row" << "\n";
+        for (int i = 0; i < results.size(); ++i)
+        {
+            const Result &r = results[i];
+            cout << left << setw(10) << r.datasetRows << setw(10) << r.dataStructure << setw(15) << r.channel
+                 << setw(9) << r.operation << right << setw(14) << Timing::format(r.timing.medianNs) << fixed
+                 << setprecision(0) << setw(16) << r.rowsPerSecond() << setprecision(1) << setw(12)
+                 << r.bytesPerRow() << "\n";
+        }
+        cout.flush();
+    }
+
+    // --- COMMAND LINE ---
+
+    void printUsage()
+    {
+        cerr << "Usage: fraud_bench [options]\n"
+             << "  --input=FILE          CSV the datasets are cut from (default " << datasetPath << ")\n"
+             << "  --generate            generate the datasets instead (see the generator options below)\n"
+             << "  --sizes=LIST          dataset rows, e.g. 10K,100K,1M,10M (the default)\n"
+             << "  --ds=LIST             data structures: list,array,columnar (default all)\n"
+             << "  --type=NAME           transaction type to search (default transfer)\n"
+             << "  --repeat=N            measured runs of search/sort/export (default " << Timing::measuredRuns << ")\n"
+             << "  --warmup=N            unmeasured runs first (default " << Timing::warmupRuns << ")\n"
+             << "  --load-runs=N         load/cleanup cycles per dataset (default 1)\n"
+             << "  --threads=N           loader threads (0 = all cores)\n"
+             << "  --sort-threads=N      array sort threads (0 = all cores)\n"
+             << "  --workdir=DIR         where the bench_<rows>.csv datasets are written (default .)\n"
+             << "  --csv=FILE            results table as CSV (default bench_results.csv)\n"
+             << "  --json=FILE           results as JSON (default bench_results.json)\n"
+             << "  --compact             write compact JSON\n"
+             << "  --no-export           skip the export step\n"
+             << "  --snapshots           allow binary snapshots (by default every load parses the CSV)\n"
+             << "Generator options:\n";
+        Generator::printOptions(cerr);
+    }
+
+    // Split a comma-separated list, calling fn on every item; stops at the first false
+    template <typename ItemFunction>
+    bool forEachItem(const string &list, ItemFunction fn)
+    {
+        size_t begin = 0;
+        while (begin <= list.size())
+        {
+            size_t comma = list.find(',', begin);
+            if (comma == string::npos) comma = list.size();
+            if (!fn(list.substr(begin, comma - begin))) return false;
+            begin = comma + 1;
+        }
+        return true;
+    }
+
+    bool parseOptions(int argc, char **argv, Options &options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            string arg = argv[i];
+            size_t equals = arg.find('=');
+            string key = arg.substr(0, equals);
+            string value = equals == string::npos ? "" : arg.substr(equals + 1);
+            int count = 0;
+            bool ok = true;
+            if (Generator::parseOption(key, value, options.generator, ok)) {}
+            else if (key == "--input") options.input = value;
+            else if (key == "--sizes")
+            {
+                options.sizeCount = 0;
+                ok = forEachItem(value, [&](const string &item) {
+                    long long rows = 0;
+                    if (options.sizeCount == MAX_SIZES || !Generator::parseRows(item, rows)) return false;
+                    options.sizes[options.sizeCount++] = rows;
+                    return true;
+                });
+            }
+            else if (key == "--ds")
+            {
+                options.list = options.array = options.columnar = false;
+                ok = forEachItem(value, [&](const string &item) {
+                    if (item == "list" || item == "linked_list") options.list = true;
+                    else if (item == "array") options.array = true;
+                    else if (item == "columnar") options.columnar = true;
+                    else return false;
+                    return true;
+                });
+            }
+            else if (key == "--type") options.type = value;
+            else if (key == "--workdir") options.workDir = value;
+            else if (key == "--csv") options.csvPath = value;
+            else if (key == "--json") options.jsonPath = value;
+            else if (key == "--repeat" && parseCount(value, count) && count > 0) Timing::measuredRuns = count;
+            else if (key == "--warmup" && parseCount(value, count)) Timing::warmupRuns = count;
+            else if (key == "--load-runs" && parseCount(value, count) && count > 0) options.loadRuns = count;
+            else if (key == "--threads" && parseCount(value, count))
+                CsvLoader::loadThreads = count == 0 ? Parallel::hardwareThreads() : static_cast<unsigned>(count);
+            else if (key == "--sort-threads" && parseCount(value, count))
+                DynamicArray::sortThreads = count == 0 ? Parallel::hardwareThreads() : static_cast<unsigned>(count);
+            else if (arg == "--compact") JsonOutput::prettyPrint = false;
+            else if (arg == "--no-export") options.exportResults = false;
+            else if (arg == "--snapshots") CsvLoader::useSnapshots = true;
+            else if (arg == "--generate") options.generate = true;
+            else ok = false;
+            if (!ok)
+            {
+                cerr << "Unknown or invalid option: " << arg << endl;
+                return false;
+            }
+        }
+        if (options.sizeCount == 0)
+        {
+            const long long defaults[] = {10000, 100000, 1000000, 10000000};
+            for (long long rows : defaults) options.sizes[options.sizeCount++] = rows;
+        }
+        return true;
+    }
+
+    int run(const Options &options)
+    {
+        Results results;
+        streambuf *console = cout.rdbuf(cerr.rdbuf()); // Loader output is progress, not results
+        bool ok = true;
+        for (int s = 0; ok && s < options.sizeCount; ++s)
+        {
+            long long rows = options.sizes[s];
+            string path;
+            if (!prepareDataset(options, rows, path)) continue;
+            datasetPath = path;
+            cerr << "\n=== " << rows << " rows (" << path << ") ===" << endl;
+            if (ok && options.list) ok = benchmarkBackend<Backends::LinkedLists>(options, rows, results);
+            if (ok && options.array) ok = benchmarkBackend<Backends::DynamicArrays>(options, rows, results);
+            if (ok && options.columnar) ok = benchmarkBackend<Backends::ColumnStores>(options, rows, results);
+        }
+        cout.rdbuf(console);
+        writeCsv(options.csvPath, results);
+        writeJson(options.jsonPath, options, results);
+        printTable(results);
+        return ok ? 0 : 1;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    CsvLoader::useSnapshots = false; // Measure parsing unless --snapshots is given
+    Benchmark::Options options;
+    if (argc > 1 && (strcmp(argv[1], "--help") == 0 || strcmp(argv[1], "-h") == 0))
+    {
+        Benchmark::printUsage();
+        return 0;
+    }
+    if (!Benchmark::parseOptions(argc, argv, options))
+    {
+        Benchmark::printUsage();
+        return 2;
+    }
+    return Benchmark::run(options);
+}
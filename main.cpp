@@ -5,11 +5,320 @@
 #include <chrono>
 #include <iomanip>  
 #include <limits>   
+#include <cstring>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <charconv>
+#include <cstdint>
+#include <cerrno>
+#include <new>
+#include <cmath>
+#include <cstdlib>
 
-#include "json.hpp" // To export results in JSON
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h> // SIMD field splitter and filter kernels
+#endif
+
+#include <cstdio>
+#include <sys/types.h>
+#include <sys/stat.h> // Source file size and modification time for snapshots
+
+#ifdef _WIN32
+#define FRAUD_NO_MMAP
+#else
+#include <sys/mman.h> // Memory-mapped CSV loading
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
-using json = nlohmann::json;
+
+// --- CATEGORY DICTIONARIES ---
+// Low-cardinality text columns are stored as small integer codes. Each column has a
+// dictionary that maps its distinct values to codes; after a load the codes follow the
+// sorted order of the values, so comparing codes orders rows like comparing the strings.
+namespace Categories {
+    typedef uint16_t Code;
+    const Code NO_CODE = 0xFFFF; // Value not in the dictionary (or dictionary full)
+
+    enum Column
+    {
+        TRANSACTION_TYPE,
+        MERCHANT_CATEGORY,
+        LOCATION,
+        DEVICE_USED,
+        FRAUD_TYPE,
+        PAYMENT_CHANNEL,
+        COLUMN_COUNT
+    };
+
+    // FNV-1a hash of a byte range
+    inline uint32_t hashBytes(const char *data, size_t length)
+    {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < length; ++i)
+        {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    // Distinct values of one column, with an open-addressing hash table for lookups
+    class Dictionary
+    {
+    public:
+        Dictionary() : values(nullptr), count(0), capacity(0), slots(nullptr), slotCount(0) {}
+        ~Dictionary() { clear(); }
+
+        void clear()
+        {
+            delete[] values;
+            delete[] slots;
+            values = nullptr;
+            slots = nullptr;
+            count = capacity = slotCount = 0;
+        }
+
+        int size() const { return count; }
+
+        // Code of a value, adding it if it is new
+        Code intern(const char *data, size_t length)
+        {
+            if (slotCount > 0)
+            {
+                int slot = findSlot(data, length);
+                if (slots[slot] >= 0) return static_cast<Code>(slots[slot]);
+            }
+            if (count >= NO_CODE) return NO_CODE;
+            if (count >= capacity) grow();
+            if ((count + 1) * 2 > slotCount) rehash(slotCount == 0 ? 16 : slotCount * 2);
+            values[count].assign(data, length);
+            slots[findSlot(data, length)] = count;
+            return static_cast<Code>(count++);
+        }
+
+        // Code of a value, or NO_CODE if it never occurred
+        Code find(const string &value) const
+        {
+            if (slotCount == 0) return NO_CODE;
+            int slot = findSlot(value.data(), value.size());
+            return slots[slot] >= 0 ? static_cast<Code>(slots[slot]) : NO_CODE;
+        }
+
+        const string &name(Code code) const
+        {
+            static const string unknown;
+            return code < count ? values[code] : unknown;
+        }
+
+    private:
+        string *values;
+        int count;
+        int capacity;
+        int *slots; // Index into values, -1 when empty
+        int slotCount;
+
+        int findSlot(const char *data, size_t length) const
+        {
+            int mask = slotCount - 1;
+            int slot = static_cast<int>(hashBytes(data, length)) & mask;
+            while (slots[slot] >= 0)
+            {
+                const string &v = values[slots[slot]];
+                if (v.size() == length && memcmp(v.data(), data, length) == 0) break;
+                slot = (slot + 1) & mask;
+            }
+            return slot;
+        }
+
+        void grow()
+        {
+            int new_capacity = (capacity == 0) ? 8 : capacity * 2;
+            string *new_values = new string[new_capacity];
+            for (int i = 0; i < count; ++i) new_values[i] = move(values[i]);
+            delete[] values;
+            values = new_values;
+            capacity = new_capacity;
+        }
+
+        void rehash(int new_slotCount)
+        {
+            delete[] slots;
+            slots = new int[new_slotCount];
+            slotCount = new_slotCount;
+            for (int i = 0; i < slotCount; ++i) slots[i] = -1;
+            for (int i = 0; i < count; ++i) slots[findSlot(values[i].data(), values[i].size())] = i;
+        }
+
+        Dictionary(const Dictionary &);
+        Dictionary &operator=(const Dictionary &);
+    };
+
+    // One dictionary per encoded column
+    struct CategorySet
+    {
+        Dictionary columns[COLUMN_COUNT];
+        Dictionary &operator[](int column) { return columns[column]; }
+        const Dictionary &operator[](int column) const { return columns[column]; }
+        void clear()
+        {
+            for (int c = 0; c < COLUMN_COUNT; ++c) columns[c].clear();
+        }
+    };
+
+    // Dictionaries of the data currently loaded
+    CategorySet dictionaries;
+
+    // Name of a code in the loaded dictionaries
+    inline const string &name(Column column, Code code)
+    {
+        return dictionaries[column].name(code);
+    }
+
+    // Code of a value in the loaded dictionaries, ignoring case (an exact match wins);
+    // NO_CODE if the column has no such value
+    inline Code findIgnoringCase(Column column, const string &value)
+    {
+        const Dictionary &dictionary = dictionaries[column];
+        Code exact = dictionary.find(value);
+        if (exact != NO_CODE) return exact;
+        for (int code = 0; code < dictionary.size(); ++code)
+        {
+            const string &name = dictionary.name(static_cast<Code>(code));
+            if (name.size() != value.size()) continue;
+            size_t i = 0;
+            while (i < name.size() && tolower(static_cast<unsigned char>(name[i])) == tolower(static_cast<unsigned char>(value[i]))) ++i;
+            if (i == name.size()) return static_cast<Code>(code);
+        }
+        return NO_CODE;
+    }
+
+    // The loaded values of a column, comma separated, for error messages
+    inline string valueList(Column column)
+    {
+        const Dictionary &dictionary = dictionaries[column];
+        string list;
+        for (int code = 0; code < dictionary.size(); ++code)
+        {
+            if (code > 0) list += ", ";
+            const string &name = dictionary.name(static_cast<Code>(code));
+            list += name.empty() ? "\"\"" : name;
+        }
+        return list;
+    }
+
+    // One partition per value of a dictionary-encoded column (e.g. per payment channel),
+    // indexed directly by code, so routing a row is an array lookup. Partitions are
+    // created on first use, each in its own allocation, and never move.
+    template <typename Partition>
+    class Partitions
+    {
+    public:
+        Partitions() : items(nullptr), count(0) {}
+        ~Partitions() { clear(); }
+
+        // Number of codes with a partition: 0 .. size() - 1
+        int size() const { return count; }
+
+        Partition &operator[](int code) { return *items[code]; }
+        const Partition &operator[](int code) const { return *items[code]; }
+
+        // Partition of a code, created (with any missing lower codes) if needed
+        Partition &partition(int code)
+        {
+            if (code >= count)
+            {
+                Partition **grown = new Partition *[code + 1];
+                for (int i = 0; i < count; ++i) grown[i] = items[i];
+                for (int i = count; i <= code; ++i) grown[i] = new Partition;
+                delete[] items;
+                items = grown;
+                count = code + 1;
+            }
+            return *items[code];
+        }
+
+        void clear()
+        {
+            for (int i = 0; i < count; ++i) delete items[i];
+            delete[] items;
+            items = nullptr;
+            count = 0;
+        }
+
+    private:
+        Partition **items;
+        int count;
+
+        Partitions(const Partitions &);
+        Partitions &operator=(const Partitions &);
+    };
+
+    // Translation from the codes of one loader worker to the shared codes
+    struct CodeRemap
+    {
+        Code *tables[COLUMN_COUNT];
+        CodeRemap()
+        {
+            for (int c = 0; c < COLUMN_COUNT; ++c) tables[c] = nullptr;
+        }
+        ~CodeRemap()
+        {
+            for (int c = 0; c < COLUMN_COUNT; ++c) delete[] tables[c];
+        }
+        Code map(Column column, Code code) const { return code == NO_CODE ? NO_CODE : tables[column][code]; }
+    };
+
+    // Merge sort of string pointers, used to order dictionary values
+    void sortValues(const string **items, const string **scratch, int count)
+    {
+        if (count < 2) return;
+        int half = count / 2;
+        sortValues(items, scratch, half);
+        sortValues(items + half, scratch, count - half);
+        int i = 0, j = half, k = 0;
+        while (i < half && j < count) scratch[k++] = (*items[j] < *items[i]) ? items[j++] : items[i++];
+        while (i < half) scratch[k++] = items[i++];
+        while (j < count) scratch[k++] = items[j++];
+        for (k = 0; k < count; ++k) items[k] = scratch[k];
+    }
+
+    // Build the shared dictionaries from the per-worker dictionaries, with codes in sorted
+    // value order, and fill in one remap per worker
+    void mergeDictionaries(const CategorySet *locals, int workers, CategorySet &shared, CodeRemap *remaps)
+    {
+        shared.clear();
+        for (int c = 0; c < COLUMN_COUNT; ++c)
+        {
+            Dictionary all;
+            for (int w = 0; w < workers; ++w)
+                for (int code = 0; code < locals[w][c].size(); ++code)
+                {
+                    const string &value = locals[w][c].name(static_cast<Code>(code));
+                    all.intern(value.data(), value.size());
+                }
+
+            const string **order = new const string *[all.size() + 1];
+            const string **scratch = new const string *[all.size() + 1];
+            for (int i = 0; i < all.size(); ++i) order[i] = &all.name(static_cast<Code>(i));
+            sortValues(order, scratch, all.size());
+            for (int i = 0; i < all.size(); ++i) shared[c].intern(order[i]->data(), order[i]->size());
+            delete[] scratch;
+            delete[] order;
+
+            for (int w = 0; w < workers; ++w)
+            {
+                int localCount = locals[w][c].size();
+                remaps[w].tables[c] = new Code[localCount > 0 ? localCount : 1];
+                for (int code = 0; code < localCount; ++code)
+                    remaps[w].tables[c][code] = shared[c].find(locals[w][c].name(static_cast<Code>(code)));
+            }
+        }
+    }
+}
 
 // --- SHARED TRANSACTION STRUCTURE ---
 struct Transaction
@@ -19,475 +328,4986 @@ struct Transaction
     string sender_account;
     string reciver_amount;
     float amount;
-    string transaction_type;
-    string merchant_category;
-    string location;
-    string device_used;
+    Categories::Code transaction_type; // Categorical columns hold dictionary codes
+    Categories::Code merchant_category;
+    Categories::Code location;
+    Categories::Code device_used;
     bool is_fraud;
-    string fraud_type;
+    Categories::Code fraud_type;
     double time_since_last_transaction;
     double spending_deviation_score;
     double velocity_score;
     double geo_anomaly_score;
-    string payement_channel;
+    Categories::Code payement_channel;
     string ip_address;
     string device_hash;
 };
 
-
 //==================================================================================
-// LINKED LIST IMPLEMENTATION
+// SHARED THREAD POOL
 //==================================================================================
 
-namespace LinkedList {
-    // Node structure for the Linked List
-    struct Node
+namespace Parallel {
+    // Number of hardware threads, at least 1
+    inline unsigned hardwareThreads()
     {
-        Transaction data;
-        Node *next;
-        Node(Transaction t) : data(t), next(nullptr) {}
-        // Default constructor for dummy node
-        Node() : next(nullptr) {}
+        unsigned n = thread::hardware_concurrency();
+        return n > 0 ? n : 1;
+    }
+
+    // Unit of work queued on the pool
+    struct Task
+    {
+        Task *next;
+        Task() : next(nullptr) {}
+        virtual ~Task() {}
+        virtual void run() = 0;
+    };
+
+    template <typename Function>
+    struct FunctionTask : Task
+    {
+        Function function;
+        explicit FunctionTask(const Function &f) : function(f) {}
+        void run() { function(); }
+    };
+
+    // Fixed set of worker threads pulling tasks from a shared FIFO queue. The thread count
+    // includes the caller, which runs queued tasks while it waits (see TaskGroup).
+    class ThreadPool
+    {
+    public:
+        explicit ThreadPool(unsigned threads)
+            : head(nullptr), tail(nullptr), stopping(false), workerCount(threads > 1 ? threads - 1 : 0)
+        {
+            workers = new thread[workerCount];
+            for (unsigned i = 0; i < workerCount; ++i) workers[i] = thread([this]() { workerLoop(); });
+        }
+
+        ~ThreadPool()
+        {
+            {
+                lock_guard<mutex> lock(queueMutex);
+                stopping = true;
+            }
+            queueReady.notify_all();
+            for (unsigned i = 0; i < workerCount; ++i) workers[i].join();
+            delete[] workers;
+            while (head != nullptr)
+            {
+                Task *next = head->next;
+                delete head;
+                head = next;
+            }
+        }
+
+        void submit(Task *task)
+        {
+            {
+                lock_guard<mutex> lock(queueMutex);
+                if (tail) tail->next = task;
+                else head = task;
+                tail = task;
+            }
+            queueReady.notify_one();
+        }
+
+        // Run one queued task on the calling thread; false if the queue was empty
+        bool runOne()
+        {
+            Task *task;
+            {
+                lock_guard<mutex> lock(queueMutex);
+                task = pop();
+            }
+            if (task == nullptr) return false;
+            task->run();
+            delete task;
+            return true;
+        }
+
+        unsigned threads() const { return workerCount + 1; }
+
+    private:
+        Task *head;
+        Task *tail;
+        bool stopping;
+        unsigned workerCount;
+        thread *workers;
+        mutex queueMutex;
+        condition_variable queueReady;
+
+        Task *pop()
+        {
+            Task *task = head;
+            if (task)
+            {
+                head = task->next;
+                if (head == nullptr) tail = nullptr;
+            }
+            return task;
+        }
+
+        void workerLoop()
+        {
+            while (true)
+            {
+                Task *task;
+                {
+                    unique_lock<mutex> lock(queueMutex);
+                    queueReady.wait(lock, [this]() { return stopping || head != nullptr; });
+                    if (head == nullptr) return; // Stopping and nothing left to do
+                    task = pop();
+                }
+                task->run();
+                delete task;
+            }
+        }
+
+        ThreadPool(const ThreadPool &);
+        ThreadPool &operator=(const ThreadPool &);
     };
 
-    struct ChannelLists
+    // Fork-join helper: run() queues work on the pool and wait() returns once all of it
+    // has finished. A waiting thread runs queued tasks itself, so nested groups cannot
+    // starve the pool.
+    class TaskGroup
     {
-        Node *card;
-        Node *ach;
-        Node *wire_transfer;
-        Node *upi;
+    public:
+        explicit TaskGroup(ThreadPool &p) : pool(p), pending(0) {}
+        ~TaskGroup() { wait(); }
+
+        template <typename Function>
+        void run(const Function &function)
+        {
+            pending++;
+            TaskGroup *group = this;
+            auto task = [group, function]() {
+                function();
+                group->pending--;
+            };
+            pool.submit(new FunctionTask<decltype(task)>(task));
+        }
+
+        void wait()
+        {
+            while (pending.load() > 0)
+                if (!pool.runOne()) this_thread::yield();
+        }
 
-        ChannelLists() : card(nullptr), ach(nullptr), wire_transfer(nullptr), upi(nullptr) {}
+    private:
+        ThreadPool &pool;
+        atomic<int> pending;
     };
+}
+
+
+//==================================================================================
+// SHARED CSV LOADER
+//==================================================================================
 
-    // Insert at the head of the list
-    void insert(Node *&head, Transaction t)
+namespace CsvLoader {
+    const int FIELD_COUNT = 18;
+
+    // Non-owning view of one field inside the mapped file
+    struct FieldView
     {
-        Node *newNode = new Node(t);
-        newNode->next = head;
-        head = newNode;
-    }
+        const char *data;
+        size_t length;
+        FieldView() : data(nullptr), length(0) {}
+        FieldView(const char *d, size_t len) : data(d), length(len) {}
+        bool empty() const { return length == 0; }
+        bool equals(const char *text) const { return strlen(text) == length && memcmp(data, text, length) == 0; }
+        string str() const { return string(data, length); }
+    };
+
+    // Column names in CSV order, used when reporting bad values
+    const char *const FIELD_NAMES[FIELD_COUNT] = {
+        "transaction_id", "timestamp", "sender_account", "reciver_amount", "amount",
+        "transaction_type", "merchant_category", "location", "device_used", "is_fraud",
+        "fraud_type", "time_since_last_transaction", "spending_deviation_score", "velocity_score",
+        "geo_anomaly_score", "payement_channel", "ip_address", "device_hash"};
+
+    // CSV column of each dictionary-encoded column, in Categories::Column order
+    const int CATEGORY_FIELDS[Categories::COLUMN_COUNT] = {5, 6, 7, 8, 10, 15};
+
+    // A numeric field that could not be parsed, or a missing payment channel
+    struct ParseError
+    {
+        size_t line;   // 1-based line in the CSV file (the header is line 1)
+        int column;    // 0-based index into FIELD_NAMES
+        char text[32]; // Start of the offending value
+    };
+
+    const int MAX_REPORTED_ERRORS = 10;
+
+    // Malformed values and rows without a channel seen during a load. Only the first few are
+    // kept, so recording an error never allocates.
+    struct ParseLog
+    {
+        size_t malformed;
+        size_t unrouted; // Rows without a payment channel, left out of every channel
+        int recorded;
+        ParseError errors[MAX_REPORTED_ERRORS];
+        ParseLog() : malformed(0), unrouted(0), recorded(0) {}
+
+        void record(size_t row, int column, const FieldView &field)
+        {
+            malformed++;
+            keep(row, column, field);
+        }
+
+        void recordUnrouted(size_t row, int column, const FieldView &field)
+        {
+            unrouted++;
+            keep(row, column, field);
+        }
+
+        void keep(size_t row, int column, const FieldView &field)
+        {
+            if (recorded == MAX_REPORTED_ERRORS) return;
+            ParseError &e = errors[recorded++];
+            e.line = row + 2;
+            e.column = column;
+            size_t n = field.length < sizeof(e.text) - 1 ? field.length : sizeof(e.text) - 1;
+            memcpy(e.text, field.data, n);
+            e.text[n] = '\0';
+        }
+
+        // Add the errors of a later chunk whose first row is rowOffset
+        void append(const ParseLog &other, size_t rowOffset)
+        {
+            malformed += other.malformed;
+            unrouted += other.unrouted;
+            for (int i = 0; i < other.recorded && recorded < MAX_REPORTED_ERRORS; ++i)
+            {
+                errors[recorded] = other.errors[i];
+                errors[recorded].line += rowOffset;
+                recorded++;
+            }
+        }
+    };
 
-    // Search by transaction type (linear search)
-    void searchByTransactionType(Node *head, const string &type)
+    // Read-only view of a whole file, mapped into memory where the platform allows it
+    class MappedFile
     {
-        Node *current = head;
-        int matchCount = 0;
-        while (current != nullptr)
+    public:
+        MappedFile() : buffer(nullptr), length(0) {}
+        ~MappedFile() { close(); }
+
+        bool open(const string &filename)
         {
-            if (current->data.transaction_type == type)
+            close();
+#ifndef FRAUD_NO_MMAP
+            int fd = ::open(filename.c_str(), O_RDONLY);
+            if (fd < 0) return false;
+            struct stat info;
+            if (fstat(fd, &info) != 0) { ::close(fd); return false; }
+            length = static_cast<size_t>(info.st_size);
+            if (length > 0)
             {
-                matchCount++;
+                void *addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (addr == MAP_FAILED) { ::close(fd); length = 0; return false; }
+                madvise(addr, length, MADV_SEQUENTIAL);
+                buffer = static_cast<char *>(addr);
             }
-            current = current->next;
+            ::close(fd); // The mapping stays valid after the descriptor is closed
+            return true;
+#else
+            ifstream file(filename, ios::binary | ios::ate);
+            if (!file.is_open()) return false;
+            length = static_cast<size_t>(file.tellg());
+            file.seekg(0);
+            buffer = new char[length > 0 ? length : 1];
+            file.read(buffer, length);
+            return true;
+#endif
         }
-        if (matchCount == 0)
-            cout << "No transactions found with type: " << type << endl;
-        else
-            cout << matchCount << " transactions found with type: " << type << endl;
+
+        void close()
+        {
+#ifndef FRAUD_NO_MMAP
+            if (buffer) munmap(buffer, length);
+#else
+            delete[] buffer;
+#endif
+            buffer = nullptr;
+            length = 0;
+        }
+
+        const char *data() const { return buffer; }
+        size_t size() const { return length; }
+
+    private:
+        char *buffer;
+        size_t length;
+        MappedFile(const MappedFile &);
+        MappedFile &operator=(const MappedFile &);
+    };
+
+    // Throughput figures for one load
+    struct LoadStats
+    {
+        size_t bytes;
+        size_t rows;
+        double seconds;
+        size_t threads;
+        bool fromSnapshot;
+        size_t allocations; // Heap allocations made by the load, counted by the caller
+        ParseLog log;
+        LoadStats() : bytes(0), rows(0), seconds(0.0), threads(1), fromSnapshot(false), allocations(0) {}
+    };
+
+    // Return the start of the line after the one beginning at p
+    inline const char *nextLine(const char *p, const char *end)
+    {
+        const char *newline = static_cast<const char *>(memchr(p, '\n', end - p));
+        return newline ? newline + 1 : end;
     }
 
-    // Helper to find the middle of the linked list
-    Node *findMiddle(Node *head)
+    // Field index being built for the current row
+    struct RowCursor
     {
-        if (head == nullptr || head->next == nullptr) return head;
-        Node *low = head, *high = head, *prev = nullptr;
-        while (high != nullptr && high->next != nullptr)
+        FieldView *fields;
+        int fieldCount;
+        const char *fieldStart;
+    };
+
+    // Record the field that ends at a comma. Commas after the last field are ignored.
+    inline void endField(RowCursor &row, const char *comma)
+    {
+        if (row.fieldCount < FIELD_COUNT)
+            row.fields[row.fieldCount++] = FieldView(row.fieldStart, comma - row.fieldStart);
+        row.fieldStart = comma + 1;
+    }
+
+    // Record the final field of the row and clear any missing trailing fields
+    inline void endRow(RowCursor &row, const char *lineEnd)
+    {
+        if (row.fieldCount < FIELD_COUNT)
         {
-            prev = low;
-            low = low->next;
-            high = high->next->next;
+            if (lineEnd > row.fieldStart && lineEnd[-1] == '\r') lineEnd--; // Tolerate CRLF files
+            row.fields[row.fieldCount++] = FieldView(row.fieldStart, lineEnd - row.fieldStart);
         }
-        if (prev) prev->next = nullptr;
-        return low;
+        for (int i = row.fieldCount; i < FIELD_COUNT; ++i) row.fields[i] = FieldView();
     }
 
-    // Helper to merge two sorted linked lists
-    Node *merge(Node *left, Node *right)
+    // Byte-at-a-time scan for the tail of a block scan (and for CPUs without SIMD)
+    inline const char *scanTail(const char *p, const char *end, RowCursor &row)
     {
-        if (!left) return right;
-        if (!right) return left;
-        Node dummyNode;
-        Node *tail = &dummyNode;
-        while (left && right)
+        for (; p < end; ++p)
         {
-            if (left->data.location <= right->data.location)
-            {
-                tail->next = left;
-                left = left->next;
-            }
-            else
+            if (*p == '\n')
             {
-                tail->next = right;
-                right = right->next;
+                endRow(row, p);
+                return p + 1;
             }
-            tail = tail->next;
+            if (*p == ',') endField(row, p);
         }
-        tail->next = left ? left : right;
-        return dummyNode.next;
+        endRow(row, end);
+        return end;
     }
-    
-    // Merge sort for the linked list
-    Node *mergeSortByLocation(Node *head)
+
+    // Split the line starting at p into comma separated fields (at most FIELD_COUNT).
+    // Missing trailing fields are left empty. Returns the start of the next line.
+    const char *splitRowScalar(const char *p, const char *end, FieldView *fields, int &fieldCount)
     {
-        if (head == nullptr || head->next == nullptr) return head;
-        Node *middle = findMiddle(head);
-        Node *left = head;
-        Node *right = middle;
-        
-        left = mergeSortByLocation(left);
-        right = mergeSortByLocation(right);
-        
-        return merge(left, right);
+        RowCursor row = {fields, 0, p};
+        const char *next = scanTail(p, end, row);
+        fieldCount = row.fieldCount;
+        return next;
     }
 
-    // Read CSV and populate the linked lists
-    void readCSV(const string &filename, ChannelLists &channels)
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define FRAUD_HAS_SIMD_SPLITTER
+    // Walk the delimiter bits found in one block. Returns the newline, or nullptr if the
+    // row continues past this block.
+    inline const char *takeDelimiters(unsigned mask, const char *block, RowCursor &row)
     {
-        ifstream file(filename);
-        if (!file.is_open())
+        while (mask != 0)
         {
-            cout << "Error: Could not open file " << filename << endl;
-            return;
+            const char *delimiter = block + __builtin_ctz(mask);
+            if (*delimiter == '\n') return delimiter;
+            endField(row, delimiter);
+            mask &= mask - 1;
         }
-        string line;
-        getline(file, line); // Skip header
-        while (getline(file, line))
+        return nullptr;
+    }
+
+    // SSE4.2: PCMPESTRM flags every ',' and '\n' in 16 bytes at once
+    __attribute__((target("sse4.2")))
+    const char *splitRowSSE42(const char *p, const char *end, FieldView *fields, int &fieldCount)
+    {
+        RowCursor row = {fields, 0, p};
+        const __m128i delimiters = _mm_setr_epi8(',', '\n', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+        for (; end - p >= 16; p += 16)
         {
-            stringstream ss(line);
-            string token;
-            Transaction t;
-            getline(ss, t.id, ',');
-            getline(ss, t.timestamp, ',');
-            getline(ss, t.sender_account, ',');
-            getline(ss, t.reciver_amount, ',');
-            getline(ss, token, ',');
-            t.amount = token.empty() ? 0.0f : stof(token);
-            getline(ss, t.transaction_type, ',');
-            getline(ss, t.merchant_category, ',');
-            getline(ss, t.location, ',');
-            getline(ss, t.device_used, ',');
-            getline(ss, token, ',');
-            t.is_fraud = (token == "1" || token == "true");
-            getline(ss, t.fraud_type, ',');
-            getline(ss, token, ',');
-            t.time_since_last_transaction = token.empty() ? 0.0 : stod(token);
-            getline(ss, token, ',');
-            t.spending_deviation_score = token.empty() ? 0.0 : stod(token);
-            getline(ss, token, ',');
-            t.velocity_score = token.empty() ? 0.0 : stod(token);
-            getline(ss, token, ',');
-            t.geo_anomaly_score = token.empty() ? 0.0 : stod(token);
-            getline(ss, t.payement_channel, ',');
-            getline(ss, t.ip_address, ',');
-            getline(ss, t.device_hash, ',');
-
-            if (t.payement_channel == "card") insert(channels.card, t);
-            else if (t.payement_channel == "ACH") insert(channels.ach, t);
-            else if (t.payement_channel == "wire_transfer") insert(channels.wire_transfer, t);
-            else if (t.payement_channel == "UPI") insert(channels.upi, t);
-        }
-        file.close();
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+            __m128i hits = _mm_cmpestrm(delimiters, 2, block, 16,
+                                        _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_BIT_MASK);
+            unsigned mask = static_cast<unsigned>(_mm_cvtsi128_si32(hits)) & 0xFFFF;
+            const char *newline = takeDelimiters(mask, p, row);
+            if (newline)
+            {
+                endRow(row, newline);
+                fieldCount = row.fieldCount;
+                return newline + 1;
+            }
+        }
+        const char *next = scanTail(p, end, row);
+        fieldCount = row.fieldCount;
+        return next;
+    }
+
+    // AVX2: compare 32 bytes against ',' and '\n' and take the combined byte mask
+    __attribute__((target("avx2")))
+    const char *splitRowAVX2(const char *p, const char *end, FieldView *fields, int &fieldCount)
+    {
+        RowCursor row = {fields, 0, p};
+        const __m256i comma = _mm256_set1_epi8(',');
+        const __m256i newlineByte = _mm256_set1_epi8('\n');
+        for (; end - p >= 32; p += 32)
+        {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+            __m256i hits = _mm256_or_si256(_mm256_cmpeq_epi8(block, comma), _mm256_cmpeq_epi8(block, newlineByte));
+            unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hits));
+            const char *newline = takeDelimiters(mask, p, row);
+            if (newline)
+            {
+                endRow(row, newline);
+                fieldCount = row.fieldCount;
+                return newline + 1;
+            }
+        }
+        const char *next = scanTail(p, end, row);
+        fieldCount = row.fieldCount;
+        return next;
+    }
+#endif
+
+    typedef const char *(*SplitRowFunction)(const char *, const char *, FieldView *, int &);
+
+    // Pick the widest splitter the CPU supports (checked once via CPUID)
+    SplitRowFunction selectSplitRow(const char *&name)
+    {
+#ifdef FRAUD_HAS_SIMD_SPLITTER
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) { name = "AVX2"; return splitRowAVX2; }
+        if (__builtin_cpu_supports("sse4.2")) { name = "SSE4.2"; return splitRowSSE42; }
+#endif
+        name = "scalar";
+        return splitRowScalar;
+    }
+
+    const char *splitterName = "scalar";
+    const SplitRowFunction splitRow = selectSplitRow(splitterName);
+
+    // Convert a numeric field straight from the mapped bytes, without locale lookups or
+    // temporary strings. Empty fields read as 0; anything that is not a complete number
+    // is logged with its row and column and also reads as 0.
+    template <typename Number>
+    Number parseNumber(const FieldView &field, size_t row, int column, ParseLog &log)
+    {
+        const char *first = field.data;
+        const char *last = field.data + field.length;
+        while (first < last && (*first == ' ' || *first == '\t')) first++;
+        while (last > first && (last[-1] == ' ' || last[-1] == '\t')) last--;
+        if (first == last) return 0;
+        if (*first == '+' && last - first > 1 && first[1] != '-') first++; // from_chars rejects a leading '+'
+
+        Number value = 0;
+        from_chars_result result = from_chars(first, last, value);
+        if (result.ec != errc() || result.ptr != last)
+        {
+            log.record(row, column, field);
+            return 0;
+        }
+        return value;
+    }
+
+    // Build a Transaction from the split fields of one row (row is 0-based, header excluded).
+    // Categorical fields are interned into the given (per-worker) dictionaries.
+    void parseTransaction(const FieldView *f, Transaction &t, size_t row, ParseLog &log, Categories::CategorySet &categories)
+    {
+        using namespace Categories;
+        t.id = f[0].str();
+        t.timestamp = f[1].str();
+        t.sender_account = f[2].str();
+        t.reciver_amount = f[3].str();
+        t.amount = parseNumber<float>(f[4], row, 4, log);
+        t.transaction_type = categories[TRANSACTION_TYPE].intern(f[5].data, f[5].length);
+        t.merchant_category = categories[MERCHANT_CATEGORY].intern(f[6].data, f[6].length);
+        t.location = categories[LOCATION].intern(f[7].data, f[7].length);
+        t.device_used = categories[DEVICE_USED].intern(f[8].data, f[8].length);
+        t.is_fraud = (f[9].equals("1") || f[9].equals("true"));
+        t.fraud_type = categories[FRAUD_TYPE].intern(f[10].data, f[10].length);
+        t.time_since_last_transaction = parseNumber<double>(f[11], row, 11, log);
+        t.spending_deviation_score = parseNumber<double>(f[12], row, 12, log);
+        t.velocity_score = parseNumber<double>(f[13], row, 13, log);
+        t.geo_anomaly_score = parseNumber<double>(f[14], row, 14, log);
+        if (f[15].empty())
+        {
+            log.recordUnrouted(row, 15, f[15]);
+            t.payement_channel = NO_CODE; // Routed to no channel
+        }
+        else t.payement_channel = categories[PAYMENT_CHANNEL].intern(f[15].data, f[15].length);
+        t.ip_address = f[16].str();
+        t.device_hash = f[17].str();
+    }
+
+    // Translate the categorical codes of a row from worker codes to the shared codes
+    inline void remapCategories(Transaction &t, const Categories::CodeRemap &remap)
+    {
+        using namespace Categories;
+        t.transaction_type = remap.map(TRANSACTION_TYPE, t.transaction_type);
+        t.merchant_category = remap.map(MERCHANT_CATEGORY, t.merchant_category);
+        t.location = remap.map(LOCATION, t.location);
+        t.device_used = remap.map(DEVICE_USED, t.device_used);
+        t.fraud_type = remap.map(FRAUD_TYPE, t.fraud_type);
+        t.payement_channel = remap.map(PAYMENT_CHANNEL, t.payement_channel);
+    }
+
+    // Worker threads used for loading; 1 selects the serial path
+    unsigned loadThreads = Parallel::hardwareThreads();
+
+    // Chunks smaller than this are not worth a thread of their own
+    const size_t MIN_CHUNK_BYTES = 1 << 20;
+
+    // --- Binary snapshot ---
+    // After a CSV load the parsed rows are saved next to the CSV as <file>.snap: the
+    // dictionaries, then fixed-size records grouped by payment channel, then the text of the
+    // string fields. Later loads map the snapshot instead of parsing the CSV, but still build
+    // every row from its record: this skips the text parsing, not the construction of the
+    // data structures, so it is a faster load rather than a store served from the mapping.
+    // It is only used when its version, record layout, checksum and the CSV's size and mtime
+    // all match. Loads only read the snapshot, and verify the checksum on every open.
+
+    // Read and write snapshots next to the CSV
+    bool useSnapshots = true;
+
+    const char SNAPSHOT_MAGIC[8] = {'F', 'R', 'A', 'U', 'D', 'S', 'N', 'P'};
+    const uint32_t SNAPSHOT_VERSION = 4;
+    const uint32_t BYTE_ORDER_MARK = 0x01020304;
+    const int TEXT_FIELDS = 6;
+
+    struct SnapshotHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint32_t recordBytes;
+        uint32_t channelCount; // Sections: one per channel code, then rows without a channel
+        uint64_t sourceBytes;
+        int64_t sourceModified; // Nanoseconds since the epoch
+        uint64_t rows;
+        uint64_t payloadBytes;
+        uint64_t checksum; // Of the payload: everything after the header
+        ParseLog log;      // Malformed values found by the CSV load, reported again on reuse
+    };
+
+    // One parsed row. The string fields are stored back to back in the text area.
+    struct SnapshotRecord
+    {
+        double time_since_last_transaction;
+        double spending_deviation_score;
+        double velocity_score;
+        double geo_anomaly_score;
+        uint64_t text; // Offset of the first string field
+        uint32_t textLength[TEXT_FIELDS];
+        float amount;
+        Categories::Code codes[Categories::COLUMN_COUNT];
+        uint8_t is_fraud;
+        uint8_t padding[3];
+    };
+
+    // 64-bit FNV-style hash over 8-byte words, fed in pieces of any size
+    class Checksum
+    {
+    public:
+        Checksum() : hash(14695981039346656037ull), pendingBytes(0) {}
+
+        void update(const void *data, size_t length)
+        {
+            const unsigned char *p = static_cast<const unsigned char *>(data);
+            while (length > 0 && pendingBytes > 0)
+            {
+                pending[pendingBytes++] = *p++;
+                length--;
+                if (pendingBytes == 8) { mix(pending); pendingBytes = 0; }
+            }
+            for (; length >= 8; p += 8, length -= 8) mix(p);
+            for (; length > 0; --length) pending[pendingBytes++] = *p++;
+        }
+
+        uint64_t value() const
+        {
+            uint64_t h = hash;
+            for (size_t i = 0; i < pendingBytes; ++i) h = (h ^ pending[i]) * 1099511628211ull;
+            return h;
+        }
+
+    private:
+        uint64_t hash;
+        unsigned char pending[8];
+        size_t pendingBytes;
+
+        void mix(const unsigned char *word)
+        {
+            uint64_t w;
+            memcpy(&w, word, sizeof(w));
+            hash = (hash ^ w) * 1099511628211ull;
+            hash ^= hash >> 29;
+        }
+    };
+
+    // Rows captured by one loader worker, with that worker's category codes
+    class SnapshotRows
+    {
+    public:
+        SnapshotRows() : records(nullptr), count(0), capacity(0), text(nullptr), textBytes(0), textCapacity(0) {}
+        ~SnapshotRows()
+        {
+            delete[] records;
+            delete[] text;
+        }
+
+        void add(const Transaction &t)
+        {
+            if (count == capacity) growRecords();
+            SnapshotRecord &r = records[count++];
+            memset(&r, 0, sizeof(r));
+            r.time_since_last_transaction = t.time_since_last_transaction;
+            r.spending_deviation_score = t.spending_deviation_score;
+            r.velocity_score = t.velocity_score;
+            r.geo_anomaly_score = t.geo_anomaly_score;
+            r.amount = t.amount;
+            r.is_fraud = t.is_fraud ? 1 : 0;
+            r.codes[Categories::TRANSACTION_TYPE] = t.transaction_type;
+            r.codes[Categories::MERCHANT_CATEGORY] = t.merchant_category;
+            r.codes[Categories::LOCATION] = t.location;
+            r.codes[Categories::DEVICE_USED] = t.device_used;
+            r.codes[Categories::FRAUD_TYPE] = t.fraud_type;
+            r.codes[Categories::PAYMENT_CHANNEL] = t.payement_channel;
+            r.text = textBytes;
+            const string *fields[TEXT_FIELDS] = {&t.id, &t.timestamp, &t.sender_account,
+                                                 &t.reciver_amount, &t.ip_address, &t.device_hash};
+            for (int i = 0; i < TEXT_FIELDS; ++i)
+            {
+                r.textLength[i] = static_cast<uint32_t>(fields[i]->size());
+                appendText(fields[i]->data(), fields[i]->size());
+            }
+        }
+
+        SnapshotRecord *records;
+        size_t count;
+        size_t capacity;
+        char *text;
+        size_t textBytes;
+        size_t textCapacity;
+
+    private:
+        void growRecords()
+        {
+            size_t new_capacity = capacity == 0 ? 4096 : capacity * 2;
+            SnapshotRecord *grown = new SnapshotRecord[new_capacity];
+            if (count > 0) memcpy(grown, records, count * sizeof(SnapshotRecord));
+            delete[] records;
+            records = grown;
+            capacity = new_capacity;
+        }
+
+        void appendText(const char *data, size_t length)
+        {
+            if (textBytes + length > textCapacity)
+            {
+                size_t new_capacity = textCapacity == 0 ? 1 << 16 : textCapacity * 2;
+                while (new_capacity < textBytes + length) new_capacity *= 2;
+                char *grown = new char[new_capacity];
+                if (textBytes > 0) memcpy(grown, text, textBytes);
+                delete[] text;
+                text = grown;
+                textCapacity = new_capacity;
+            }
+            memcpy(text + textBytes, data, length);
+            textBytes += length;
+        }
+
+        SnapshotRows(const SnapshotRows &);
+        SnapshotRows &operator=(const SnapshotRows &);
+    };
+
+    string snapshotPath(const string &filename) { return filename + ".snap"; }
+
+    // Size and modification time of the source file
+    bool sourceInfo(const string &filename, uint64_t &bytes, int64_t &modified)
+    {
+        struct stat info;
+        if (stat(filename.c_str(), &info) != 0) return false;
+        bytes = static_cast<uint64_t>(info.st_size);
+#if defined(__linux__)
+        modified = static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+#else
+        modified = static_cast<int64_t>(info.st_mtime) * 1000000000;
+#endif
+        return true;
+    }
+
+    // Payload writer that keeps the running checksum
+    struct SnapshotOutput
+    {
+        ofstream file;
+        Checksum sum;
+        uint64_t bytes;
+        SnapshotOutput() : bytes(0) {}
+        void write(const void *data, size_t length)
+        {
+            file.write(static_cast<const char *>(data), length);
+            sum.update(data, length);
+            bytes += length;
+        }
+    };
+
+    // Write the snapshot of a finished CSV load. Rows are regrouped by their shared payment
+    // channel code; within a channel they keep file order. The file is written under a
+    // temporary name and renamed, so a reader never sees a partial snapshot.
+    void writeSnapshot(const string &filename, const SnapshotRows *rows, const Categories::CodeRemap *remaps,
+                       size_t workers, const ParseLog &log)
+    {
+        using namespace Categories;
+        SnapshotHeader header = SnapshotHeader();
+        if (!sourceInfo(filename, header.sourceBytes, header.sourceModified)) return;
+        memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+        header.version = SNAPSHOT_VERSION;
+        header.byteOrder = BYTE_ORDER_MARK;
+        header.recordBytes = sizeof(SnapshotRecord);
+        header.channelCount = static_cast<uint32_t>(dictionaries[PAYMENT_CHANNEL].size());
+        header.log = log;
+
+        string path = snapshotPath(filename), temporary = path + ".tmp";
+        SnapshotOutput out;
+        out.file.open(temporary, ios::binary | ios::trunc);
+        if (!out.file.is_open()) return;
+        out.file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+        for (int c = 0; c < COLUMN_COUNT; ++c)
+        {
+            uint32_t count = static_cast<uint32_t>(dictionaries[c].size());
+            out.write(&count, sizeof(count));
+            for (uint32_t code = 0; code < count; ++code)
+            {
+                const string &value = dictionaries[c].name(static_cast<Code>(code));
+                uint32_t length = static_cast<uint32_t>(value.size());
+                out.write(&length, sizeof(length));
+                out.write(value.data(), length);
+            }
+        }
+
+        // Rows per section, then the records section by section. The counting pass notes
+        // each record's section; the records are then bucketed by section (keeping file
+        // order within one) and written in a single pass.
+        uint32_t sections = header.channelCount + 1;
+        uint64_t *sectionRows = new uint64_t[sections];
+        for (uint32_t i = 0; i < sections; ++i) sectionRows[i] = 0;
+        uint64_t *textBase = new uint64_t[workers + 1];
+        textBase[0] = 0;
+        for (size_t w = 0; w < workers; ++w)
+        {
+            textBase[w + 1] = textBase[w] + rows[w].textBytes;
+            header.rows += rows[w].count;
+        }
+        uint32_t *sectionOf = new uint32_t[header.rows > 0 ? header.rows : 1];
+        for (size_t w = 0, g = 0; w < workers; ++w)
+            for (size_t r = 0; r < rows[w].count; ++r, ++g)
+            {
+                Code channel = remaps[w].map(PAYMENT_CHANNEL, rows[w].records[r].codes[PAYMENT_CHANNEL]);
+                sectionOf[g] = channel < header.channelCount ? channel : header.channelCount;
+                sectionRows[sectionOf[g]]++;
+            }
+        out.write(sectionRows, sections * sizeof(uint64_t));
+        static const char zeros[8] = {0};
+        out.write(zeros, (8 - out.bytes % 8) % 8); // Align the records
+
+        struct RecordRef
+        {
+            uint32_t worker;
+            uint32_t row;
+        };
+        RecordRef *bucketed = new RecordRef[header.rows > 0 ? header.rows : 1];
+        uint64_t *next = new uint64_t[sections]; // Next free slot of each section's bucket
+        uint64_t start = 0;
+        for (uint32_t i = 0; i < sections; ++i)
+        {
+            next[i] = start;
+            start += sectionRows[i];
+        }
+        for (size_t w = 0, g = 0; w < workers; ++w)
+            for (size_t r = 0; r < rows[w].count; ++r, ++g)
+            {
+                RecordRef &ref = bucketed[next[sectionOf[g]]++];
+                ref.worker = static_cast<uint32_t>(w);
+                ref.row = static_cast<uint32_t>(r);
+            }
+        for (uint64_t i = 0; i < header.rows; ++i)
+        {
+            const RecordRef &ref = bucketed[i];
+            SnapshotRecord record = rows[ref.worker].records[ref.row];
+            for (int c = 0; c < COLUMN_COUNT; ++c)
+                record.codes[c] = remaps[ref.worker].map(static_cast<Column>(c), record.codes[c]);
+            record.text += textBase[ref.worker];
+            out.write(&record, sizeof(record));
+        }
+        for (size_t w = 0; w < workers; ++w) out.write(rows[w].text, rows[w].textBytes);
+        delete[] next;
+        delete[] bucketed;
+        delete[] sectionOf;
+        delete[] textBase;
+        delete[] sectionRows;
+
+        header.payloadBytes = out.bytes;
+        header.checksum = out.sum.value();
+        out.file.seekp(0);
+        out.file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.file.close();
+        if (!out.file || rename(temporary.c_str(), path.c_str()) != 0)
+        {
+            remove(temporary.c_str());
+            cout << "Warning: could not write snapshot " << path << endl;
+        }
+    }
+
+    // Build a Transaction from a snapshot record
+    inline void restoreTransaction(const SnapshotRecord &r, const char *text, Transaction &t)
+    {
+        using namespace Categories;
+        string *fields[TEXT_FIELDS] = {&t.id, &t.timestamp, &t.sender_account,
+                                       &t.reciver_amount, &t.ip_address, &t.device_hash};
+        const char *p = text + r.text;
+        for (int i = 0; i < TEXT_FIELDS; ++i)
+        {
+            fields[i]->assign(p, r.textLength[i]);
+            p += r.textLength[i];
+        }
+        t.amount = r.amount;
+        t.is_fraud = r.is_fraud != 0;
+        t.time_since_last_transaction = r.time_since_last_transaction;
+        t.spending_deviation_score = r.spending_deviation_score;
+        t.velocity_score = r.velocity_score;
+        t.geo_anomaly_score = r.geo_anomaly_score;
+        t.transaction_type = r.codes[TRANSACTION_TYPE];
+        t.merchant_category = r.codes[MERCHANT_CATEGORY];
+        t.location = r.codes[LOCATION];
+        t.device_used = r.codes[DEVICE_USED];
+        t.fraud_type = r.codes[FRAUD_TYPE];
+        t.payement_channel = r.codes[PAYMENT_CHANNEL];
+    }
+
+    // A mapped snapshot whose header, checksum and layout have been checked
+    struct SnapshotView
+    {
+        MappedFile file;
+        const SnapshotHeader *header;
+        const char *dictionaries;
+        const char *sectionRows; // channelCount + 1 uint64 row counts, unaligned
+        const SnapshotRecord *records;
+        const char *text;
+        uint64_t textBytes;
+    };
+
+    // Map the snapshot of filename and check it still describes that file
+    bool openSnapshot(const string &filename, SnapshotView &view)
+    {
+        uint64_t sourceBytes;
+        int64_t sourceModified;
+        if (!sourceInfo(filename, sourceBytes, sourceModified)) return false;
+        if (!view.file.open(snapshotPath(filename)) || view.file.size() < sizeof(SnapshotHeader)) return false;
+
+        SnapshotHeader header;
+        memcpy(&header, view.file.data(), sizeof(header));
+        if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 || header.version != SNAPSHOT_VERSION ||
+            header.byteOrder != BYTE_ORDER_MARK || header.recordBytes != sizeof(SnapshotRecord) ||
+            header.sourceBytes != sourceBytes || header.sourceModified != sourceModified ||
+            header.payloadBytes != view.file.size() - sizeof(SnapshotHeader))
+            return false;
+        const char *payload = view.file.data() + sizeof(SnapshotHeader);
+        const char *end = payload + header.payloadBytes;
+        Checksum sum;
+        sum.update(payload, header.payloadBytes);
+        if (sum.value() != header.checksum) return false;
+
+        // Walk the dictionaries to find the section table
+        const char *p = payload;
+        for (int c = 0; c < Categories::COLUMN_COUNT; ++c)
+        {
+            uint32_t count, length;
+            if (end - p < 4) return false;
+            memcpy(&count, p, 4);
+            p += 4;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                if (end - p < 4) return false;
+                memcpy(&length, p, 4);
+                if (static_cast<uint64_t>(end - p - 4) < length) return false;
+                p += 4 + length;
+            }
+        }
+        uint64_t sections = static_cast<uint64_t>(header.channelCount) + 1;
+        if (static_cast<uint64_t>(end - p) < sections * 8) return false;
+        view.sectionRows = p;
+        p += sections * 8;
+        p += (8 - (p - payload) % 8) % 8;
+        if (static_cast<uint64_t>(end - p) / sizeof(SnapshotRecord) < header.rows) return false;
+
+        view.header = reinterpret_cast<const SnapshotHeader *>(view.file.data());
+        view.dictionaries = payload;
+        view.records = reinterpret_cast<const SnapshotRecord *>(p);
+        view.text = p + header.rows * sizeof(SnapshotRecord);
+        view.textBytes = end - view.text;
+        return true;
+    }
+
+    // Fill the partition from a valid snapshot. Record ranges are replayed on separate
+    // threads into partials that are merged in snapshot order, like a parallel CSV load.
+    // Records are grouped by channel, so each partial can first reserve room for the rows
+    // of every channel its range holds.
+    template <typename Partition, typename RowHandler, typename MergeHandler, typename ReserveHandler>
+    bool loadSnapshot(const string &filename, Partition &result, LoadStats &stats, RowHandler handleRow,
+                      MergeHandler mergePartial, ReserveHandler reserveRows)
+    {
+        using namespace Categories;
+        auto start = chrono::steady_clock::now();
+        SnapshotView view;
+        if (!openSnapshot(filename, view)) return false;
+        const SnapshotHeader &header = *view.header;
+        size_t rows = static_cast<size_t>(header.rows);
+        for (size_t r = 0; r < rows; ++r)
+        {
+            const SnapshotRecord &record = view.records[r];
+            uint64_t length = 0;
+            for (int i = 0; i < TEXT_FIELDS; ++i) length += record.textLength[i];
+            if (record.text > view.textBytes || length > view.textBytes - record.text) return false;
+        }
+
+        dictionaries.clear();
+        const char *p = view.dictionaries;
+        for (int c = 0; c < COLUMN_COUNT; ++c)
+        {
+            uint32_t count, length;
+            memcpy(&count, p, 4);
+            p += 4;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                memcpy(&length, p, 4);
+                dictionaries[c].intern(p + 4, length); // Stored in code order
+                p += 4 + length;
+            }
+        }
+        CodeRemap identity;
+        for (int c = 0; c < COLUMN_COUNT; ++c)
+        {
+            int count = dictionaries[c].size();
+            identity.tables[c] = new Code[count > 0 ? count : 1];
+            for (int code = 0; code < count; ++code) identity.tables[c][code] = static_cast<Code>(code);
+        }
+
+        size_t workers = loadThreads > 0 ? loadThreads : 1;
+        size_t minRows = MIN_CHUNK_BYTES / sizeof(SnapshotRecord);
+        if (workers > rows / minRows) workers = rows / minRows;
+        if (workers < 1) workers = 1;
+        Partition *partials = new Partition[workers];
+        auto replay = [&](size_t w) {
+            RowHandler localHandler = handleRow;
+            size_t first = rows / workers * w, last = w + 1 == workers ? rows : rows / workers * (w + 1);
+            uint64_t sectionStart = 0;
+            for (uint32_t section = 0; section < header.channelCount; ++section)
+            {
+                uint64_t count;
+                memcpy(&count, view.sectionRows + section * 8, 8);
+                uint64_t from = sectionStart > first ? sectionStart : first;
+                uint64_t to = sectionStart + count < last ? sectionStart + count : last;
+                if (from < to) reserveRows(partials[w], static_cast<Code>(section), static_cast<size_t>(to - from));
+                sectionStart += count;
+            }
+            for (size_t r = first; r < last; ++r)
+            {
+                Transaction t;
+                restoreTransaction(view.records[r], view.text, t);
+                localHandler(partials[w], move(t), dictionaries);
+            }
+        };
+        if (workers == 1)
+            replay(0);
+        else
+        {
+            thread *pool = new thread[workers];
+            for (size_t w = 0; w < workers; ++w) pool[w] = thread(replay, w);
+            for (size_t w = 0; w < workers; ++w) pool[w].join();
+            delete[] pool;
+        }
+        for (size_t w = 0; w < workers; ++w) mergePartial(result, partials[w], identity);
+        delete[] partials;
+
+        stats = LoadStats();
+        stats.bytes = view.file.size();
+        stats.rows = rows;
+        stats.threads = workers;
+        stats.log = header.log;
+        stats.fromSnapshot = true;
+        stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        return true;
+    }
+
+    // Parse every row in [p, end) into one partition, returns the number of rows read.
+    // Row numbers in the log are relative to p. Rows are also copied into capture when given.
+    // Each row is parsed into one Transaction that is then moved into the partition.
+    template <typename Partition, typename RowHandler>
+    size_t parseRange(const char *p, const char *end, Partition &partition, RowHandler &handleRow, ParseLog &log,
+                      Categories::CategorySet &categories, SnapshotRows *capture)
+    {
+        FieldView fields[FIELD_COUNT];
+        int fieldCount = 0;
+        size_t rows = 0;
+        while (p < end)
+        {
+            p = splitRow(p, end, fields, fieldCount);
+            Transaction t;
+            parseTransaction(fields, t, rows, log, categories);
+            if (capture) capture->add(t);
+            handleRow(partition, move(t), categories);
+            rows++;
+        }
+        return rows;
+    }
+
+    // Map the file and parse every data row into the partition.
+    // With more than one worker the data is split into newline-aligned byte ranges, each
+    // range is parsed into its own partial partition, and the partials are merged in file
+    // order so the result is identical to the serial path.
+    // Workers intern categorical values into their own dictionaries; the merge builds the
+    // shared sorted dictionaries and mergePartial translates each partial's codes.
+    // A valid snapshot is used instead of the CSV; otherwise one is written after parsing.
+    // reserveRows(partition, channel, rows) makes room for rows known in advance (snapshot
+    // loads only).
+    template <typename Partition, typename RowHandler, typename MergeHandler, typename ReserveHandler>
+    bool load(const string &filename, Partition &result, LoadStats &stats, RowHandler handleRow, MergeHandler mergePartial,
+              ReserveHandler reserveRows)
+    {
+        if (useSnapshots && loadSnapshot(filename, result, stats, handleRow, mergePartial, reserveRows)) return true;
+        auto start = chrono::steady_clock::now();
+        MappedFile file;
+        if (!file.open(filename))
+        {
+            cout << "Error: Could not open file " << filename << endl;
+            return false;
+        }
+        const char *begin = file.data();
+        const char *end = begin + file.size();
+        if (begin != end) begin = nextLine(begin, end); // Skip header
+
+        stats = LoadStats();
+        stats.bytes = file.size();
+
+        size_t dataBytes = end - begin;
+        size_t workers = loadThreads > 0 ? loadThreads : 1;
+        if (workers > dataBytes / MIN_CHUNK_BYTES) workers = dataBytes / MIN_CHUNK_BYTES;
+        if (workers < 1) workers = 1;
+        stats.threads = workers;
+
+        // Chunk boundaries always sit at the start of a line
+        const char **bounds = new const char *[workers + 1];
+        bounds[0] = begin;
+        for (size_t i = 1; i < workers; ++i)
+        {
+            const char *split = begin + dataBytes / workers * i;
+            if (split < bounds[i - 1]) split = bounds[i - 1];
+            bounds[i] = (split > begin && split[-1] == '\n') ? split : nextLine(split, end);
+        }
+        bounds[workers] = end;
+
+        Partition *partials = new Partition[workers];
+        Categories::CategorySet *categories = new Categories::CategorySet[workers];
+        size_t *rowCounts = new size_t[workers];
+        ParseLog *logs = new ParseLog[workers];
+        SnapshotRows *captures = useSnapshots ? new SnapshotRows[workers] : nullptr;
+        if (workers == 1)
+        {
+            rowCounts[0] = parseRange(begin, end, partials[0], handleRow, logs[0], categories[0], captures);
+        }
+        else
+        {
+            thread *pool = new thread[workers];
+            for (size_t i = 0; i < workers; ++i)
+            {
+                pool[i] = thread([&, i]() {
+                    RowHandler localHandler = handleRow;
+                    rowCounts[i] = parseRange(bounds[i], bounds[i + 1], partials[i], localHandler, logs[i], categories[i],
+                                              captures ? captures + i : nullptr);
+                });
+            }
+            for (size_t i = 0; i < workers; ++i) pool[i].join();
+            delete[] pool;
+        }
+
+        Categories::CodeRemap *remaps = new Categories::CodeRemap[workers];
+        Categories::mergeDictionaries(categories, static_cast<int>(workers), Categories::dictionaries, remaps);
+        for (size_t i = 0; i < workers; ++i)
+        {
+            mergePartial(result, partials[i], remaps[i]);
+            stats.log.append(logs[i], stats.rows);
+            stats.rows += rowCounts[i];
+        }
+        stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (captures) writeSnapshot(filename, captures, remaps, workers, stats.log);
+        delete[] captures;
+        delete[] remaps;
+        delete[] logs;
+        delete[] rowCounts;
+        delete[] categories;
+        delete[] partials;
+        delete[] bounds;
+        return true;
+    }
+
+    // Load into partitions that have nothing to reserve
+    template <typename Partition, typename RowHandler, typename MergeHandler>
+    bool load(const string &filename, Partition &result, LoadStats &stats, RowHandler handleRow, MergeHandler mergePartial)
+    {
+        return load(filename, result, stats, handleRow, mergePartial, [](Partition &, Categories::Code, size_t) {});
+    }
+
+    // Print the load throughput counter
+    void printLoadStats(const LoadStats &stats)
+    {
+        double mb = static_cast<double>(stats.bytes) / (1024 * 1024);
+        double seconds = stats.seconds > 0.0 ? stats.seconds : 1e-9;
+        cout << "Loaded " << stats.rows << " rows (" << fixed << setprecision(2) << mb << " MB) in "
+             << stats.seconds * 1000.0 << " ms | " << mb / seconds << " MB/s | "
+             << setprecision(0) << stats.rows / seconds << " rows/s | "
+             << stats.threads << (stats.threads == 1 ? " thread" : " threads") << " | ";
+        if (stats.allocations > 0) cout << stats.allocations << " allocations | ";
+        if (stats.fromSnapshot)
+            cout << "from snapshot" << endl;
+        else
+            cout << splitterName << " splitter" << endl;
+        cout.unsetf(ios::floatfield);
+        cout << setprecision(6);
+
+        const ParseLog &log = stats.log;
+        for (int c = 0; c < Categories::COLUMN_COUNT; ++c)
+            if (Categories::dictionaries[c].size() >= Categories::NO_CODE)
+                cout << "Warning: " << FIELD_NAMES[CATEGORY_FIELDS[c]] << " has more distinct values than "
+                     << "the dictionary can hold; extra values are not searchable" << endl;
+        if (log.malformed == 0 && log.unrouted == 0) return;
+        if (log.malformed > 0) cout << "Warning: " << log.malformed << " malformed numeric value(s) were read as 0" << endl;
+        if (log.unrouted > 0)
+            cout << "Warning: " << log.unrouted << " row(s) without a payment channel were left out" << endl;
+        for (int i = 0; i < log.recorded; ++i)
+        {
+            const ParseError &e = log.errors[i];
+            cout << "  line " << e.line << ", column " << e.column + 1 << " (" << FIELD_NAMES[e.column]
+                 << "): \"" << e.text << "\"" << endl;
+        }
+        if (log.malformed + log.unrouted > static_cast<size_t>(log.recorded))
+            cout << "  ... and " << log.malformed + log.unrouted - log.recorded << " more" << endl;
+    }
+}
+
+
+//==================================================================================
+// SHARED INDEXES
+//==================================================================================
+
+namespace Index {
+    // Result of one search: the matching rows (positions or node pointers) in row order.
+    // It is either a view into an index's postings or a buffer collected by a scan, which
+    // the set then owns. Count, export and metrics all read the same set.
+    template <typename Posting>
+    class MatchSet
+    {
+    public:
+        MatchSet() : items(nullptr), owned(nullptr), count(0) {}
+        MatchSet(const Posting *view, int n) : items(view), owned(nullptr), count(n) {}
+        MatchSet(MatchSet &&other) : items(other.items), owned(other.owned), count(other.count)
+        {
+            other.items = other.owned = nullptr;
+            other.count = 0;
+        }
+        ~MatchSet() { delete[] owned; }
+
+        MatchSet &operator=(MatchSet &&other)
+        {
+            if (this == &other) return *this;
+            delete[] owned;
+            items = other.items;
+            owned = other.owned;
+            count = other.count;
+            other.items = other.owned = nullptr;
+            other.count = 0;
+            return *this;
+        }
+
+        // Take ownership of a buffer filled by a scan
+        static MatchSet adopt(Posting *buffer, int n)
+        {
+            MatchSet matches(buffer, n);
+            matches.owned = buffer;
+            return matches;
+        }
+
+        int size() const { return count; }
+        bool empty() const { return count == 0; }
+        const Posting &operator[](int i) const { return items[i]; }
+
+    private:
+        const Posting *items;
+        Posting *owned;
+        int count;
+
+        MatchSet(const MatchSet &);
+        MatchSet &operator=(const MatchSet &);
+    };
+
+    void printMatchCount(int matchCount, const string &type)
+    {
+        if (matchCount == 0)
+            cout << "No transactions found with type: " << type << endl;
+        else
+            cout << matchCount << " transactions found with type: " << type << endl;
+    }
+
+    // Inverted index from a category code to the rows holding it, kept in row order.
+    // Postings of all codes share one array (offsets[c] .. offsets[c + 1] belong to code c),
+    // so a lookup is two reads and the matches are contiguous.
+    template <typename Posting>
+    class PostingIndex
+    {
+    public:
+        PostingIndex() : offsets(nullptr), postings(nullptr), codeCount(0), rowCount(0) {}
+        ~PostingIndex() { clear(); }
+
+        void clear()
+        {
+            delete[] offsets;
+            delete[] postings;
+            offsets = nullptr;
+            postings = nullptr;
+            codeCount = rowCount = 0;
+        }
+
+        // Build the index in two passes over the rows. forEachRow(visit) must call
+        // visit(posting, code) for every row, in row order.
+        template <typename ForEachRow>
+        void build(int codes, int rows, ForEachRow forEachRow)
+        {
+            clear();
+            codeCount = codes;
+            rowCount = rows;
+            offsets = new int[codeCount + 1];
+            postings = new Posting[rowCount > 0 ? rowCount : 1];
+            for (int c = 0; c <= codeCount; ++c) offsets[c] = 0;
+            forEachRow([this](Posting, Categories::Code code) {
+                if (code < codeCount) offsets[code + 1]++;
+            });
+            for (int c = 0; c < codeCount; ++c) offsets[c + 1] += offsets[c];
+            int *cursor = new int[codeCount > 0 ? codeCount : 1];
+            for (int c = 0; c < codeCount; ++c) cursor[c] = offsets[c];
+            forEachRow([this, cursor](Posting posting, Categories::Code code) {
+                if (code < codeCount) postings[cursor[code]++] = posting;
+            });
+            delete[] cursor;
+        }
+
+        int count(Categories::Code code) const
+        {
+            return code < codeCount ? offsets[code + 1] - offsets[code] : 0;
+        }
+
+        // Postings of a code, in row order, without copying them
+        MatchSet<Posting> match(Categories::Code code) const
+        {
+            if (code >= codeCount) return MatchSet<Posting>();
+            return MatchSet<Posting>(postings + offsets[code], count(code));
+        }
+
+    private:
+        int *offsets;
+        Posting *postings;
+        int codeCount;
+        int rowCount;
+
+        PostingIndex(const PostingIndex &);
+        PostingIndex &operator=(const PostingIndex &);
+    };
+}
+
+
+//==================================================================================
+// COMPRESSED BITMAP INDEXES
+//==================================================================================
+
+// Roaring-style bitmaps of row positions. Rows are grouped by their high 16 bits into
+// containers; a container with at most 4096 rows stores their low 16 bits as a sorted
+// array (2 bytes per row), a denser one as a 65536-bit bitmap (8 KB). Intersection and
+// union work container by container, so their cost follows the compressed size rather
+// than the number of rows.
+
+namespace Roaring {
+    const int ARRAY_MAX = 4096;      // Larger containers are bitmaps
+    const int BITMAP_WORDS = 1024;   // 65536 bits
+
+    struct Container
+    {
+        uint16_t key;      // High 16 bits of the rows
+        int cardinality;
+        uint16_t *values;  // Sorted low 16 bits, while cardinality <= ARRAY_MAX
+        int capacity;      // Of values
+        uint64_t *words;   // Bitmap of the low 16 bits otherwise
+    };
+
+    class Bitmap
+    {
+    public:
+        Bitmap() : containers(nullptr), count(0), capacity(0), total(0) {}
+        Bitmap(Bitmap &&other) : containers(other.containers), count(other.count), capacity(other.capacity), total(other.total)
+        {
+            other.containers = nullptr;
+            other.count = other.capacity = other.total = 0;
+        }
+        ~Bitmap() { clear(); }
+
+        Bitmap &operator=(Bitmap &&other)
+        {
+            if (this == &other) return *this;
+            clear();
+            containers = other.containers;
+            count = other.count;
+            capacity = other.capacity;
+            total = other.total;
+            other.containers = nullptr;
+            other.count = other.capacity = other.total = 0;
+            return *this;
+        }
+
+        void clear()
+        {
+            for (int c = 0; c < count; ++c)
+            {
+                delete[] containers[c].values;
+                delete[] containers[c].words;
+            }
+            delete[] containers;
+            containers = nullptr;
+            count = capacity = total = 0;
+        }
+
+        // Number of rows in the set, without walking it
+        int cardinality() const { return total; }
+
+        // Append a row; rows must be added in increasing order, as a column scan does
+        void add(int row)
+        {
+            uint16_t key = static_cast<uint16_t>(row >> 16), low = static_cast<uint16_t>(row & 0xFFFF);
+            if (count == 0 || containers[count - 1].key != key) appendContainer(key);
+            Container &c = containers[count - 1];
+            if (c.words)
+                c.words[low >> 6] |= uint64_t(1) << (low & 63);
+            else if (c.cardinality < ARRAY_MAX)
+            {
+                if (c.cardinality == c.capacity) growArray(c, c.capacity == 0 ? 4 : c.capacity * 2);
+                c.values[c.cardinality] = low;
+            }
+            else
+            {
+                toBitmap(c);
+                c.words[low >> 6] |= uint64_t(1) << (low & 63);
+            }
+            c.cardinality++;
+            total++;
+        }
+
+        // Release the unused capacity of array containers once building is done
+        void shrink()
+        {
+            for (int c = 0; c < count; ++c)
+                if (!containers[c].words && containers[c].capacity > containers[c].cardinality)
+                    growArray(containers[c], containers[c].cardinality);
+        }
+
+        // Heap bytes held by the bitmap
+        size_t bytes() const
+        {
+            size_t b = static_cast<size_t>(capacity) * sizeof(Container);
+            for (int c = 0; c < count; ++c)
+                b += containers[c].words ? BITMAP_WORDS * sizeof(uint64_t) : containers[c].capacity * sizeof(uint16_t);
+            return b;
+        }
+
+        // Write the rows in increasing order; returns their number
+        int toPositions(int *positions) const
+        {
+            int n = 0;
+            for (int c = 0; c < count; ++c)
+            {
+                const Container &container = containers[c];
+                int base = static_cast<int>(container.key) << 16;
+                if (!container.words)
+                {
+                    for (int i = 0; i < container.cardinality; ++i) positions[n++] = base | container.values[i];
+                    continue;
+                }
+                for (int w = 0; w < BITMAP_WORDS; ++w)
+                    for (uint64_t word = container.words[w]; word != 0; word &= word - 1)
+                        positions[n++] = base + w * 64 + __builtin_ctzll(word);
+            }
+            return n;
+        }
+
+        // Expand into a flat bitmap of size rows (bit i % 64 of word i / 64 is row i)
+        void toWords(uint64_t *bits, int size) const
+        {
+            int words = (size + 63) / 64;
+            for (int w = 0; w < words; ++w) bits[w] = 0;
+            for (int c = 0; c < count; ++c)
+            {
+                const Container &container = containers[c];
+                int first = static_cast<int>(container.key) * BITMAP_WORDS;
+                if (!container.words)
+                {
+                    for (int i = 0; i < container.cardinality; ++i)
+                        bits[first + (container.values[i] >> 6)] |= uint64_t(1) << (container.values[i] & 63);
+                    continue;
+                }
+                for (int w = 0; w < BITMAP_WORDS && first + w < words; ++w) bits[first + w] = container.words[w];
+            }
+        }
+
+        // Rows in both a and b
+        static Bitmap intersect(const Bitmap &a, const Bitmap &b)
+        {
+            Bitmap result;
+            int i = 0, j = 0;
+            while (i < a.count && j < b.count)
+            {
+                const Container &x = a.containers[i], &y = b.containers[j];
+                if (x.key < y.key) { ++i; continue; }
+                if (y.key < x.key) { ++j; continue; }
+                result.intersectContainers(x, y);
+                ++i;
+                ++j;
+            }
+            return result;
+        }
+
+        // Rows in any of the n sets, merged one container key at a time
+        static Bitmap unite(const Bitmap *const *sets, int n)
+        {
+            Bitmap result;
+            int *next = new int[n > 0 ? n : 1]; // Next container of each set
+            for (int s = 0; s < n; ++s) next[s] = 0;
+            while (true)
+            {
+                int key = -1; // Smallest key not merged yet
+                for (int s = 0; s < n; ++s)
+                    if (next[s] < sets[s]->count && (key < 0 || sets[s]->containers[next[s]].key < key))
+                        key = sets[s]->containers[next[s]].key;
+                if (key < 0) break;
+                uint64_t *words = new uint64_t[BITMAP_WORDS];
+                for (int w = 0; w < BITMAP_WORDS; ++w) words[w] = 0;
+                for (int s = 0; s < n; ++s)
+                    if (next[s] < sets[s]->count && sets[s]->containers[next[s]].key == key)
+                        addTo(words, sets[s]->containers[next[s]++]);
+                int cardinality = 0;
+                for (int w = 0; w < BITMAP_WORDS; ++w) cardinality += __builtin_popcountll(words[w]);
+                result.appendWords(static_cast<uint16_t>(key), words, cardinality);
+            }
+            delete[] next;
+            return result;
+        }
+
+    private:
+        Container *containers; // In increasing key order
+        int count;
+        int capacity;
+        int total;
+
+        Bitmap(const Bitmap &);
+        Bitmap &operator=(const Bitmap &);
+
+        static bool contains(const Container &c, uint16_t low)
+        {
+            if (c.words) return (c.words[low >> 6] >> (low & 63)) & 1;
+            int lo = 0, hi = c.cardinality - 1;
+            while (lo <= hi)
+            {
+                int mid = (lo + hi) / 2;
+                if (c.values[mid] == low) return true;
+                if (c.values[mid] < low) lo = mid + 1;
+                else hi = mid - 1;
+            }
+            return false;
+        }
+
+        static void growArray(Container &c, int newCapacity)
+        {
+            uint16_t *grown = new uint16_t[newCapacity > 0 ? newCapacity : 1];
+            for (int i = 0; i < c.cardinality; ++i) grown[i] = c.values[i];
+            delete[] c.values;
+            c.values = grown;
+            c.capacity = newCapacity;
+        }
+
+        static void toBitmap(Container &c)
+        {
+            c.words = new uint64_t[BITMAP_WORDS];
+            for (int w = 0; w < BITMAP_WORDS; ++w) c.words[w] = 0;
+            for (int i = 0; i < c.cardinality; ++i) c.words[c.values[i] >> 6] |= uint64_t(1) << (c.values[i] & 63);
+            delete[] c.values;
+            c.values = nullptr;
+            c.capacity = 0;
+        }
+
+        Container &appendContainer(uint16_t key)
+        {
+            if (count == capacity)
+            {
+                int newCapacity = capacity == 0 ? 4 : capacity * 2;
+                Container *grown = new Container[newCapacity];
+                for (int c = 0; c < count; ++c) grown[c] = containers[c];
+                delete[] containers;
+                containers = grown;
+                capacity = newCapacity;
+            }
+            Container &c = containers[count++];
+            c.key = key;
+            c.cardinality = 0;
+            c.values = nullptr;
+            c.capacity = 0;
+            c.words = nullptr;
+            return c;
+        }
+
+        // Append a container holding the given bitmap words, as an array if it is sparse
+        void appendWords(uint16_t key, uint64_t *words, int cardinality)
+        {
+            if (cardinality == 0)
+            {
+                delete[] words;
+                return;
+            }
+            Container &c = appendContainer(key);
+            total += cardinality;
+            if (cardinality > ARRAY_MAX)
+            {
+                c.words = words;
+                c.cardinality = cardinality;
+                return;
+            }
+            growArray(c, cardinality);
+            c.cardinality = cardinality;
+            int n = 0;
+            for (int w = 0; w < BITMAP_WORDS; ++w)
+                for (uint64_t word = words[w]; word != 0; word &= word - 1)
+                    c.values[n++] = static_cast<uint16_t>(w * 64 + __builtin_ctzll(word));
+            delete[] words;
+        }
+
+        void intersectContainers(const Container &x, const Container &y)
+        {
+            if (x.words && y.words)
+            {
+                uint64_t *words = new uint64_t[BITMAP_WORDS];
+                int cardinality = 0;
+                for (int w = 0; w < BITMAP_WORDS; ++w)
+                {
+                    words[w] = x.words[w] & y.words[w];
+                    cardinality += __builtin_popcountll(words[w]);
+                }
+                appendWords(x.key, words, cardinality);
+                return;
+            }
+            // At least one side is an array: keep its values that the other side holds
+            const Container &small = x.words ? y : x, &other = x.words ? x : y;
+            uint16_t *values = new uint16_t[small.cardinality > 0 ? small.cardinality : 1];
+            int n = 0;
+            for (int i = 0; i < small.cardinality; ++i)
+                if (contains(other, small.values[i])) values[n++] = small.values[i];
+            if (n > 0)
+            {
+                Container &c = appendContainer(x.key);
+                c.values = values;
+                c.capacity = small.cardinality;
+                c.cardinality = n;
+                total += n;
+            }
+            else delete[] values;
+        }
+
+        // OR a container's rows into bitmap words
+        static void addTo(uint64_t *words, const Container &c)
+        {
+            if (c.words)
+                for (int w = 0; w < BITMAP_WORDS; ++w) words[w] |= c.words[w];
+            else
+                for (int i = 0; i < c.cardinality; ++i) words[c.values[i] >> 6] |= uint64_t(1) << (c.values[i] & 63);
+        }
+    };
+
+    // One bitmap per value of a small-integer column (a dictionary code or a flag)
+    class ValueIndex
+    {
+    public:
+        ValueIndex() : bitmaps(nullptr), count(0) {}
+        ~ValueIndex() { clear(); }
+
+        void clear()
+        {
+            delete[] bitmaps;
+            bitmaps = nullptr;
+            count = 0;
+        }
+
+        // Index the first rows of column, whose values are below values
+        template <typename T>
+        void build(const T *column, int rows, int values)
+        {
+            clear();
+            count = values;
+            bitmaps = new Bitmap[count > 0 ? count : 1];
+            for (int i = 0; i < rows; ++i)
+            {
+                int value = static_cast<int>(column[i]);
+                if (value < count) bitmaps[value].add(i);
+            }
+            for (int v = 0; v < count; ++v) bitmaps[v].shrink();
+        }
+
+        // Rows holding value (an empty set for values not in the index)
+        const Bitmap &rows(int value) const
+        {
+            static const Bitmap none;
+            return value >= 0 && value < count ? bitmaps[value] : none;
+        }
+
+        size_t bytes() const
+        {
+            size_t b = static_cast<size_t>(count) * sizeof(Bitmap);
+            for (int v = 0; v < count; ++v) b += bitmaps[v].bytes();
+            return b;
+        }
+
+    private:
+        Bitmap *bitmaps;
+        int count;
+
+        ValueIndex(const ValueIndex &);
+        ValueIndex &operator=(const ValueIndex &);
+    };
+}
+
+
+//==================================================================================
+// SHARED JSON WRITER
+//==================================================================================
+
+namespace JsonOutput {
+    // Indent exports with 4 spaces; compact output puts the whole document on one line
+    bool prettyPrint = true;
+
+    const size_t BUFFER_BYTES = 1 << 16;
+    const int MAX_DEPTH = 32;
+
+    // Streaming (SAX-style) JSON writer. Records are formatted into a fixed buffer that is
+    // flushed to the file as it fills, so export memory stays constant whatever the row count.
+    // The path "-" writes to standard output.
+    class Writer
+    {
+    public:
+        explicit Writer(const char *path, bool pretty = prettyPrint)
+            : used(0), depth(0), afterKey(false), pretty(pretty), failed(false), toStdout(strcmp(path, "-") == 0)
+        {
+#ifdef _WIN32
+            file = toStdout ? stdout : fopen(path, "wb");
+            failed = file == nullptr;
+#else
+            fd = toStdout ? STDOUT_FILENO : ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            failed = fd < 0;
+#endif
+            if (failed) cout << "Error: Could not write file " << path << endl;
+        }
+
+        ~Writer()
+        {
+            put('\n');
+            flush();
+            if (toStdout) return;
+#ifdef _WIN32
+            if (file) fclose(file);
+#else
+            if (fd >= 0) ::close(fd);
+#endif
+        }
+
+        bool ok() const { return !failed; }
+
+        void beginObject() { open('{'); }
+        void endObject() { close('}'); }
+        void beginArray() { open('['); }
+        void endArray() { close(']'); }
+
+        void key(const char *name)
+        {
+            separate();
+            quoted(name, strlen(name));
+            put(':');
+            if (pretty) put(' ');
+            afterKey = true;
+        }
+
+        void value(const std::string &text) { separate(); quoted(text.data(), text.size()); }
+        void value(const char *text) { separate(); quoted(text, strlen(text)); }
+        void value(bool flag) { separate(); raw(flag ? "true" : "false"); }
+        void value(int number) { separate(); integer(number); }
+        void value(long long number) { separate(); integer(number); }
+        void value(size_t number) { separate(); integer(number); }
+        void value(float number) { separate(); real(number); }
+        void value(double number) { separate(); real(number); }
+
+        // key + value in one call
+        template <typename Value>
+        void field(const char *name, const Value &v)
+        {
+            key(name);
+            value(v);
+        }
+
+    private:
+        char buffer[BUFFER_BYTES];
+        size_t used;
+#ifdef _WIN32
+        FILE *file;
+#else
+        int fd;
+#endif
+        int counts[MAX_DEPTH]; // Members written so far at each open level
+        int depth;
+        bool afterKey;
+        bool pretty;
+        bool failed;
+        bool toStdout;
+
+        void flush()
+        {
+            const char *p = buffer;
+            while (used > 0 && !failed)
+            {
+#ifdef _WIN32
+                size_t written = fwrite(p, 1, used, file);
+                if (written == 0) failed = true;
+#else
+                ssize_t written = ::write(fd, p, used);
+                if (written < 0)
+                {
+                    if (errno == EINTR) continue;
+                    failed = true;
+                    break;
+                }
+#endif
+                p += written;
+                used -= written;
+            }
+            used = 0;
+        }
+
+        void put(char c)
+        {
+            if (used == BUFFER_BYTES) flush();
+            buffer[used++] = c;
+        }
+
+        void raw(const char *text, size_t length)
+        {
+            for (size_t i = 0; i < length; ++i) put(text[i]);
+        }
+        void raw(const char *text) { raw(text, strlen(text)); }
+
+        void newline()
+        {
+            if (!pretty) return;
+            put('\n');
+            for (int i = 0; i < depth * 4; ++i) put(' ');
+        }
+
+        // Comma and indentation before a value or key
+        void separate()
+        {
+            if (afterKey)
+            {
+                afterKey = false;
+                return;
+            }
+            if (depth == 0 || depth > MAX_DEPTH) return; // Past MAX_DEPTH the writer has failed
+            if (counts[depth - 1]++ > 0) put(',');
+            newline();
+        }
+
+        void open(char bracket)
+        {
+            separate();
+            put(bracket);
+            if (depth == MAX_DEPTH && !failed)
+            {
+                cout << "Error: JSON nesting deeper than " << MAX_DEPTH << " levels" << endl;
+                failed = true; // Nothing more is written; deeper levels have no member count
+            }
+            if (depth < MAX_DEPTH) counts[depth] = 0;
+            depth++;
+        }
+
+        void close(char bracket)
+        {
+            depth--;
+            if (depth < MAX_DEPTH && counts[depth] > 0) newline();
+            put(bracket);
+        }
+
+        void quoted(const char *text, size_t length)
+        {
+            static const char HEX[] = "0123456789abcdef";
+            put('"');
+            for (size_t i = 0; i < length; ++i)
+            {
+                unsigned char c = static_cast<unsigned char>(text[i]);
+                switch (c)
+                {
+                case '"': raw("\\\""); break;
+                case '\\': raw("\\\\"); break;
+                case '\b': raw("\\b"); break;
+                case '\f': raw("\\f"); break;
+                case '\n': raw("\\n"); break;
+                case '\r': raw("\\r"); break;
+                case '\t': raw("\\t"); break;
+                default:
+                    if (c < 0x20)
+                    {
+                        raw("\\u00");
+                        put(HEX[c >> 4]);
+                        put(HEX[c & 0xF]);
+                    }
+                    else
+                        put(static_cast<char>(c));
+                }
+            }
+            put('"');
+        }
+
+        template <typename Integer>
+        void integer(Integer number)
+        {
+            char text[24];
+            raw(text, to_chars(text, text + sizeof(text), number).ptr - text);
+        }
+
+        // Shortest text that reads back as the same value; non-finite values become null
+        template <typename Real>
+        void real(Real number)
+        {
+            if (number != number || number - number != 0)
+            {
+                raw("null");
+                return;
+            }
+            char text[32];
+            size_t length = to_chars(text, text + sizeof(text), number).ptr - text;
+            raw(text, length);
+            if (!memchr(text, '.', length) && !memchr(text, 'e', length)) raw(".0");
+        }
+    };
+}
+
+//==================================================================================
+// SHARED TIMING
+//==================================================================================
+
+namespace Timing {
+    // Unmeasured runs before the measured ones, and measured runs per operation
+    unsigned warmupRuns = 1;
+    unsigned measuredRuns = 5;
+
+    // Summary of the measured runs of one operation, in nanoseconds
+    struct Stats
+    {
+        int warmup;
+        int runs;
+        double minNs;
+        double medianNs;
+        double p95Ns;
+        double p99Ns;
+        double meanNs;
+        double stddevNs;
+        Stats() : warmup(0), runs(0), minNs(0), medianNs(0), p95Ns(0), p99Ns(0), meanNs(0), stddevNs(0) {}
+        double medianMs() const { return medianNs / 1e6; }
+    };
+
+    // Nearest-rank percentile (0 < q <= 1) of sorted samples
+    inline double percentile(const long long *sorted, int count, double q)
+    {
+        int rank = static_cast<int>(q * count + 0.999999);
+        if (rank < 1) rank = 1;
+        if (rank > count) rank = count;
+        return static_cast<double>(sorted[rank - 1]);
+    }
+
+    // Summarize samples; they are sorted in place. Run counts are small, so insertion sort.
+    Stats summarize(long long *samples, int count, int warmup)
+    {
+        Stats stats;
+        stats.warmup = warmup;
+        stats.runs = count;
+        if (count == 0) return stats;
+        for (int i = 1; i < count; ++i)
+        {
+            long long value = samples[i];
+            int j = i - 1;
+            for (; j >= 0 && samples[j] > value; --j) samples[j + 1] = samples[j];
+            samples[j + 1] = value;
+        }
+        double sum = 0.0;
+        for (int i = 0; i < count; ++i) sum += static_cast<double>(samples[i]);
+        stats.meanNs = sum / count;
+        double squares = 0.0;
+        for (int i = 0; i < count; ++i)
+        {
+            double d = samples[i] - stats.meanNs;
+            squares += d * d;
+        }
+        stats.stddevNs = count > 1 ? sqrt(squares / (count - 1)) : 0.0;
+        stats.minNs = static_cast<double>(samples[0]);
+        stats.medianNs = count % 2 ? static_cast<double>(samples[count / 2])
+                                   : (static_cast<double>(samples[count / 2 - 1]) + samples[count / 2]) / 2.0;
+        stats.p95Ns = percentile(samples, count, 0.95);
+        stats.p99Ns = percentile(samples, count, 0.99);
+        return stats;
+    }
+
+    // Run op warmup + runs times on the steady clock and summarize the measured runs.
+    // prepare() runs untimed before every run (e.g. to restore unsorted input); the
+    // measured samples are copied to samplesOut, in run order, when it is given.
+    template <typename Prepare, typename Operation>
+    Stats measure(Prepare prepare, Operation op, int warmup = warmupRuns, int runs = measuredRuns,
+                  long long *samplesOut = nullptr)
+    {
+        if (runs < 1) runs = 1;
+        long long *samples = new long long[runs];
+        for (int i = 0; i < warmup + runs; ++i)
+        {
+            prepare(i);
+            auto start = chrono::steady_clock::now();
+            op();
+            long long ns = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+            if (i >= warmup) samples[i - warmup] = ns;
+        }
+        if (samplesOut)
+            for (int i = 0; i < runs; ++i) samplesOut[i] = samples[i];
+        Stats stats = summarize(samples, runs, warmup);
+        delete[] samples;
+        return stats;
+    }
+
+    // Human-readable duration with a unit that keeps 3-4 significant digits
+    string format(double ns)
+    {
+        ostringstream text;
+        text << fixed;
+        if (ns < 1e3) text << setprecision(0) << ns << " ns";
+        else if (ns < 1e6) text << setprecision(2) << ns / 1e3 << " us";
+        else if (ns < 1e9) text << setprecision(3) << ns / 1e6 << " ms";
+        else text << setprecision(3) << ns / 1e9 << " s";
+        return text.str();
+    }
+
+    // Median as execution_time_ms plus the full summary under "timing"
+    void writeJson(JsonOutput::Writer &out, const Stats &stats)
+    {
+        out.field("execution_time_ms", stats.medianMs());
+        out.key("timing");
+        out.beginObject();
+        out.field("warmup_runs", stats.warmup);
+        out.field("runs", stats.runs);
+        out.field("min_ns", stats.minNs);
+        out.field("median_ns", stats.medianNs);
+        out.field("p95_ns", stats.p95Ns);
+        out.field("p99_ns", stats.p99Ns);
+        out.field("mean_ns", stats.meanNs);
+        out.field("stddev_ns", stats.stddevNs);
+        out.endObject();
+    }
+}
+
+//==================================================================================
+// SHARED MEMORY ACCOUNTING
+//==================================================================================
+
+namespace Memory {
+    // Heap bytes requested through operator new and not yet freed, the highest value
+    // reached, and the number of allocations (counted by the global operator new below)
+    atomic<size_t> liveBytes(0);
+    atomic<size_t> peakBytes(0);
+    atomic<size_t> allocationCount(0);
+
+    inline void recordAllocation(size_t bytes)
+    {
+        size_t live = liveBytes.fetch_add(bytes, memory_order_relaxed) + bytes;
+        allocationCount.fetch_add(1, memory_order_relaxed);
+        size_t peak = peakBytes.load(memory_order_relaxed);
+        while (live > peak && !peakBytes.compare_exchange_weak(peak, live, memory_order_relaxed)) {}
+    }
+
+    inline void recordFree(size_t bytes) { liveBytes.fetch_sub(bytes, memory_order_relaxed); }
+
+    // Heap counters plus the resident set size and its peak from /proc/self/status
+    // (0 where unavailable), sampled at one point in time
+    struct ProcessMemory
+    {
+        size_t heapLiveBytes;
+        size_t heapPeakBytes;
+        size_t allocations;
+        size_t rssBytes;
+        size_t peakRssBytes;
+        ProcessMemory() : heapLiveBytes(0), heapPeakBytes(0), allocations(0), rssBytes(0), peakRssBytes(0) {}
+    };
+
+    ProcessMemory readProcessMemory()
+    {
+        ProcessMemory result;
+        result.heapLiveBytes = liveBytes.load();
+        result.heapPeakBytes = peakBytes.load();
+        result.allocations = allocationCount.load();
+        ifstream status("/proc/self/status");
+        string line;
+        while (getline(status, line))
+        {
+            size_t *target = line.compare(0, 6, "VmRSS:") == 0 ? &result.rssBytes
+                           : line.compare(0, 6, "VmHWM:") == 0 ? &result.peakRssBytes : nullptr;
+            if (!target) continue;
+            size_t kb = 0;
+            const char *p = line.c_str() + 6;
+            while (*p == ' ' || *p == '\t') ++p;
+            from_chars(p, line.c_str() + line.size(), kb);
+            *target = kb * 1024;
+        }
+        return result;
+    }
+
+    // Where the memory of one channel goes
+    struct Usage
+    {
+        size_t rowBytes;       // Transaction structs or column values of the stored rows
+        size_t nodeOverhead;   // Per-node links and padding, arena block headers
+        size_t stringPayload;  // Heap buffers of strings too long for the inline buffer
+        size_t containerSlack; // Reserved but unused capacity
+        size_t indexBytes;     // Secondary indexes (bitmap indexes of the column stores)
+        Usage() : rowBytes(0), nodeOverhead(0), stringPayload(0), containerSlack(0), indexBytes(0) {}
+        size_t total() const { return rowBytes + nodeOverhead + stringPayload + containerSlack + indexBytes; }
+        Usage &operator+=(const Usage &other)
+        {
+            rowBytes += other.rowBytes;
+            nodeOverhead += other.nodeOverhead;
+            stringPayload += other.stringPayload;
+            containerSlack += other.containerSlack;
+            indexBytes += other.indexBytes;
+            return *this;
+        }
+        double totalMB() const { return static_cast<double>(total()) / (1024 * 1024); }
+    };
+
+    // Heap bytes held by one string (0 when it fits in the inline buffer)
+    inline size_t stringPayload(const string &s)
+    {
+        static const size_t INLINE_CAPACITY = string().capacity();
+        return s.capacity() > INLINE_CAPACITY ? s.capacity() + 1 : 0;
+    }
+
+    inline size_t stringPayload(const Transaction &t)
+    {
+        return stringPayload(t.id) + stringPayload(t.timestamp) + stringPayload(t.sender_account) +
+               stringPayload(t.reciver_amount) + stringPayload(t.ip_address) + stringPayload(t.device_hash);
+    }
+
+    string formatMB(size_t bytes)
+    {
+        ostringstream text;
+        text << fixed << setprecision(2) << static_cast<double>(bytes) / (1024 * 1024) << " MB";
+        return text.str();
+    }
+
+    // One-line breakdown for the metrics table
+    string describe(const Usage &usage)
+    {
+        return "rows " + formatMB(usage.rowBytes) + ", nodes " + formatMB(usage.nodeOverhead) + ", strings " +
+               formatMB(usage.stringPayload) + ", slack " + formatMB(usage.containerSlack);
+    }
+
+    // Channel totals as memory_usage_mb / space_used_bytes, the breakdown and the
+    // process-wide figures under "memory"
+    void writeJson(JsonOutput::Writer &out, const Usage &usage, const ProcessMemory &process = readProcessMemory())
+    {
+        out.field("memory_usage_mb", usage.totalMB());
+        out.field("space_used_bytes", usage.total());
+        out.key("memory");
+        out.beginObject();
+        out.field("row_bytes", usage.rowBytes);
+        out.field("node_overhead_bytes", usage.nodeOverhead);
+        out.field("string_payload_bytes", usage.stringPayload);
+        out.field("container_slack_bytes", usage.containerSlack);
+        out.field("index_bytes", usage.indexBytes);
+        out.field("heap_live_bytes", process.heapLiveBytes);
+        out.field("heap_peak_bytes", process.heapPeakBytes);
+        out.field("heap_allocations", process.allocations);
+        out.field("rss_bytes", process.rssBytes);
+        out.field("peak_rss_bytes", process.peakRssBytes);
+        out.endObject();
+    }
+}
+
+#ifndef FRAUD_NO_ALLOC_HOOK
+// Global allocation hook: every block carries its size in a 16-byte header so frees can
+// be subtracted from Memory::liveBytes. Define FRAUD_NO_ALLOC_HOOK to build without it.
+namespace Memory {
+    const size_t HEADER_BYTES = 16;
+
+    inline void *hookedAllocate(size_t bytes) noexcept
+    {
+        void *block = malloc(bytes + HEADER_BYTES);
+        if (!block) return nullptr;
+        *static_cast<size_t *>(block) = bytes;
+        recordAllocation(bytes);
+        return static_cast<char *>(block) + HEADER_BYTES;
+    }
+
+    inline void hookedFree(void *p) noexcept
+    {
+        if (!p) return;
+        void *block = static_cast<char *>(p) - HEADER_BYTES;
+        recordFree(*static_cast<size_t *>(block));
+        free(block);
+    }
+
+    inline void *hookedNew(size_t bytes)
+    {
+        for (;;)
+        {
+            if (void *p = hookedAllocate(bytes ? bytes : 1)) return p;
+            new_handler handler = get_new_handler();
+            if (!handler) throw bad_alloc();
+            handler();
+        }
+    }
+}
+
+void *operator new(size_t bytes) { return Memory::hookedNew(bytes); }
+void *operator new[](size_t bytes) { return Memory::hookedNew(bytes); }
+void *operator new(size_t bytes, const nothrow_t &) noexcept { return Memory::hookedAllocate(bytes ? bytes : 1); }
+void *operator new[](size_t bytes, const nothrow_t &) noexcept { return Memory::hookedAllocate(bytes ? bytes : 1); }
+void operator delete(void *p) noexcept { Memory::hookedFree(p); }
+void operator delete[](void *p) noexcept { Memory::hookedFree(p); }
+void operator delete(void *p, size_t) noexcept { Memory::hookedFree(p); }
+void operator delete[](void *p, size_t) noexcept { Memory::hookedFree(p); }
+void operator delete(void *p, const nothrow_t &) noexcept { Memory::hookedFree(p); }
+void operator delete[](void *p, const nothrow_t &) noexcept { Memory::hookedFree(p); }
+#endif
+
+//==================================================================================
+// SYNTHETIC DATASET GENERATOR
+//==================================================================================
+
+namespace Generator {
+    const char *const HEADER =
+        "transaction_id,timestamp,sender_account,receiver_account,amount,transaction_type,merchant_category,"
+        "location,device_used,is_fraud,fraud_type,time_since_last_transaction,spending_deviation_score,"
+        "velocity_score,geo_anomaly_score,payment_channel,ip_address,device_hash\n";
+
+    // Category values with relative weights, chosen by one uniform draw per row
+    struct Distribution
+    {
+        static const int MAX_VALUES = 64;
+        static const size_t MAX_LENGTH = 48; // Keeps every row within ROW_BYTES
+        string values[MAX_VALUES];
+        double cumulative[MAX_VALUES]; // Running share of the weights; the last one is 1
+        int count;
+        Distribution() : count(0) {}
+        explicit Distribution(const char *spec) : count(0) { parse(spec); }
+
+        // Parse "a:3,b:1" (relative weights) or "a,b" (equal weights); false on bad input
+        bool parse(const string &spec)
+        {
+            string names[MAX_VALUES];
+            double weights[MAX_VALUES];
+            int n = 0;
+            double total = 0.0;
+            size_t begin = 0;
+            while (begin <= spec.size())
+            {
+                size_t comma = spec.find(',', begin);
+                if (comma == string::npos) comma = spec.size();
+                string item = spec.substr(begin, comma - begin);
+                begin = comma + 1;
+                double weight = 1.0;
+                size_t colon = item.rfind(':');
+                if (colon != string::npos)
+                {
+                    const char *end = item.data() + item.size();
+                    from_chars_result parsed = from_chars(item.data() + colon + 1, end, weight);
+                    if (parsed.ec != errc() || parsed.ptr != end || weight < 0) return false;
+                    item.resize(colon);
+                }
+                if (item.empty() || item.size() > MAX_LENGTH || n == MAX_VALUES) return false;
+                names[n] = item;
+                weights[n++] = weight;
+                total += weight;
+            }
+            if (total <= 0) return false;
+            double running = 0.0;
+            for (int i = 0; i < n; ++i)
+            {
+                values[i] = names[i];
+                running += weights[i];
+                cumulative[i] = running / total;
+            }
+            cumulative[n - 1] = 1.0;
+            count = n;
+            return true;
+        }
+
+        size_t maxLength() const
+        {
+            size_t longest = 0;
+            for (int i = 0; i < count; ++i)
+                if (values[i].size() > longest) longest = values[i].size();
+            return longest;
+        }
+
+        // u is uniform in [0, 1)
+        const string &pick(double u) const
+        {
+            int i = 0;
+            while (i + 1 < count && u >= cumulative[i]) ++i;
+            return values[i];
+        }
+    };
+
+    const long long POWERS_OF_TEN[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+
+    // Closed interval a numeric column is drawn from, uniformly, written with a fixed number
+    // of decimals
+    struct Range
+    {
+        static const int MAX_DIGITS = 15; // Scaled bounds stay exact in a double and far from overflow
+        double low;
+        double high;
+        int decimals;
+        Range(double l, double h, int d) : low(l), high(h), decimals(d) {}
+
+        // Parse "MIN:MAX"; false unless both bounds fit in MAX_DIGITS digits with the decimals
+        bool parse(const string &spec)
+        {
+            size_t colon = spec.find(':');
+            if (colon == string::npos) return false;
+            double l = 0, h = 0;
+            const char *end = spec.data() + spec.size();
+            from_chars_result first = from_chars(spec.data(), spec.data() + colon, l);
+            from_chars_result second = from_chars(spec.data() + colon + 1, end, h);
+            if (first.ec != errc() || first.ptr != spec.data() + colon || second.ec != errc() || second.ptr != end || !(l <= h))
+                return false;
+            double limit = pow(10.0, MAX_DIGITS - decimals);
+            if (!(l > -limit && h < limit)) return false;
+            low = l;
+            high = h;
+            return true;
+        }
+
+        // Most characters a value can take: sign, digits and decimal point
+        size_t maxWidth() const
+        {
+            long long unit = POWERS_OF_TEN[decimals];
+            long long lowest = llround(low * unit), highest = llround(high * unit);
+            if (lowest < 0) lowest = -lowest;
+            if (highest < 0) highest = -highest;
+            long long largest = lowest > highest ? lowest : highest;
+            size_t digits = 1;
+            for (long long rest = largest / 10; rest > 0; rest /= 10) ++digits;
+            if (digits < static_cast<size_t>(decimals) + 1) digits = decimals + 1; // 0.xx
+            return (low < 0 ? 1 : 0) + digits + (decimals > 0 ? 1 : 0);
+        }
+    };
+
+    // Everything that shapes the generated data. Defaults follow the public dataset.
+    struct Config
+    {
+        long long rows;
+        uint64_t seed;
+        double fraudRate;
+        Distribution transactionTypes;
+        Distribution merchantCategories;
+        Distribution locations;
+        Distribution devices;
+        Distribution channels;
+        Distribution fraudTypes;
+        Range amount;
+        Range timeSinceLast;
+        Range spendingDeviation;
+        Range velocity; // Whole numbers
+        Range geoAnomaly;
+        unsigned threads;
+        Config()
+            : rows(0), seed(42), fraudRate(0.036),
+              transactionTypes("withdrawal,deposit,transfer,payment"),
+              merchantCategories("utilities,online,other,travel,grocery,retail,restaurant,entertainment"),
+              locations("Tokyo,Toronto,London,Sydney,New York,Dubai,Berlin,Singapore"),
+              devices("mobile,atm,pos,web"),
+              channels("card,ACH,wire_transfer,UPI"),
+              fraudTypes("card_not_present,phishing,money_laundering,account_takeover,malware"),
+              amount(0.01, 5000.0, 2), timeSinceLast(-5000.0, 5000.0, 6), spendingDeviation(-5.0, 5.0, 2),
+              velocity(1, 20, 0), geoAnomaly(0.0, 1.0, 2), threads(Parallel::hardwareThreads()) {}
+    };
+
+    // SplitMix64: tiny state, fast, and good enough for test data
+    class Random
+    {
+    public:
+        explicit Random(uint64_t seed) : state(seed) {}
+
+        uint64_t next()
+        {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        // Uniform in [0, 1)
+        double uniform() { return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0); }
+
+        // Uniform integer in [low, high]
+        long long between(long long low, long long high)
+        {
+            return low + static_cast<long long>(next() % static_cast<uint64_t>(high - low + 1));
+        }
+
+    private:
+        uint64_t state;
+    };
+
+    // --- ROW FORMATTING ---
+    // Values are drawn as scaled integers and written digit by digit, which is both faster
+    // than formatting doubles and exact, so a seed always produces the same bytes.
+
+    inline char *writeInteger(char *p, long long value) { return to_chars(p, p + 20, value).ptr; }
+
+    // value with exactly `width` digits, zero-padded
+    inline char *writeDigits(char *p, long long value, int width)
+    {
+        for (int d = width - 1; d >= 0; --d)
+        {
+            p[d] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        }
+        return p + width;
+    }
+
+    // A number drawn from range, with the range's number of decimals
+    inline char *writeDecimal(char *p, const Range &range, Random &random)
+    {
+        int decimals = range.decimals;
+        long long unit = POWERS_OF_TEN[decimals];
+        long long scaled = random.between(llround(range.low * unit), llround(range.high * unit));
+        if (scaled < 0)
+        {
+            *p++ = '-';
+            scaled = -scaled;
+        }
+        p = writeInteger(p, scaled / unit);
+        if (decimals == 0) return p;
+        *p++ = '.';
+        return writeDigits(p, scaled % unit, decimals);
+    }
+
+    inline char *writeString(char *p, const string &value)
+    {
+        memcpy(p, value.data(), value.size());
+        return p + value.size();
+    }
+
+    // ISO timestamp with microseconds, somewhere in 2023
+    inline char *writeTimestamp(char *p, Random &random)
+    {
+        static const int MONTH_STARTS[] = {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334, 365};
+        long long second = random.between(0, 365LL * 86400 - 1);
+        int day = static_cast<int>(second / 86400);
+        int month = 0;
+        while (day >= MONTH_STARTS[month + 1]) ++month;
+        int secondOfDay = static_cast<int>(second % 86400);
+        p = writeString(p, "2023-");
+        p = writeDigits(p, month + 1, 2);
+        *p++ = '-';
+        p = writeDigits(p, day - MONTH_STARTS[month] + 1, 2);
+        *p++ = 'T';
+        p = writeDigits(p, secondOfDay / 3600, 2);
+        *p++ = ':';
+        p = writeDigits(p, secondOfDay / 60 % 60, 2);
+        *p++ = ':';
+        p = writeDigits(p, secondOfDay % 60, 2);
+        *p++ = '.';
+        return writeDigits(p, random.between(0, 999999), 6);
+    }
+
+    // One CSV line for row `index`, in the column order readCSV expects
+    char *writeRow(char *p, long long index, const Config &config, Random &random)
+    {
+        bool fraud = random.uniform() < config.fraudRate;
+        *p++ = 'T';
+        p = writeInteger(p, index);
+        *p++ = ',';
+        p = writeTimestamp(p, random);
+        p = writeString(p, ",ACC");
+        p = writeDigits(p, random.between(100000, 999999), 6);
+        p = writeString(p, ",ACC");
+        p = writeDigits(p, random.between(100000, 999999), 6);
+        *p++ = ',';
+        p = writeDecimal(p, config.amount, random);
+        *p++ = ',';
+        p = writeString(p, config.transactionTypes.pick(random.uniform()));
+        *p++ = ',';
+        p = writeString(p, config.merchantCategories.pick(random.uniform()));
+        *p++ = ',';
+        p = writeString(p, config.locations.pick(random.uniform()));
+        *p++ = ',';
+        p = writeString(p, config.devices.pick(random.uniform()));
+        p = writeString(p, fraud ? ",true," : ",false,");
+        if (fraud) p = writeString(p, config.fraudTypes.pick(random.uniform()));
+        *p++ = ',';
+        p = writeDecimal(p, config.timeSinceLast, random);
+        *p++ = ',';
+        p = writeDecimal(p, config.spendingDeviation, random);
+        *p++ = ',';
+        p = writeDecimal(p, config.velocity, random);
+        *p++ = ',';
+        p = writeDecimal(p, config.geoAnomaly, random);
+        *p++ = ',';
+        p = writeString(p, config.channels.pick(random.uniform()));
+        *p++ = ',';
+        uint64_t ip = random.next();
+        for (int octet = 0; octet < 4; ++octet)
+        {
+            if (octet > 0) *p++ = '.';
+            p = writeInteger(p, static_cast<long long>((ip >> (octet * 8)) & 0xFF));
+        }
+        p = writeString(p, ",D");
+        p = writeDigits(p, random.between(1000000, 9999999), 7);
+        *p++ = '\n';
+        return p;
+    }
+
+    // --- GENERATION ---
+
+    const long long BLOCK_ROWS = 16384;
+    const size_t ROW_BYTES = 512; // Upper bound of one formatted row
+
+    // Longest line writeRow can produce with this config, field by field
+    size_t maxRowBytes(const Config &config)
+    {
+        size_t bytes = 20 + 1 + 26 + 2 * 10; // T<index>,<timestamp>,ACC<6>,ACC<6>
+        bytes += 1 + config.amount.maxWidth();
+        bytes += 4 + config.transactionTypes.maxLength() + config.merchantCategories.maxLength() +
+                 config.locations.maxLength() + config.devices.maxLength();
+        size_t fraudType = config.fraudTypes.maxLength();
+        bytes += 6 + fraudType > 7 ? 6 + fraudType : 7; // ,true,<fraud type> or ,false,
+        bytes += 1 + config.timeSinceLast.maxWidth() + 1 + config.spendingDeviation.maxWidth();
+        bytes += 1 + config.velocity.maxWidth() + 1 + config.geoAnomaly.maxWidth();
+        bytes += 1 + config.channels.maxLength() + 1 + 15 + 9 + 1; // ,<ip>,D<7> and the newline
+        return bytes;
+    }
+
+    // Format one block of rows into buffer and return its length. Every block has its own
+    // random stream derived from the seed, so the output does not depend on the thread count
+    // and a smaller dataset is a prefix of a larger one with the same seed.
+    size_t generateBlock(const Config &config, long long block, char *buffer)
+    {
+        Random random(Random(config.seed ^ (0xD1B54A32D192ED03ULL * static_cast<uint64_t>(block + 1))).next());
+        long long first = block * BLOCK_ROWS;
+        long long last = first + BLOCK_ROWS < config.rows ? first + BLOCK_ROWS : config.rows;
+        char *p = buffer;
+        for (long long i = first; i < last; ++i) p = writeRow(p, i, config, random);
+        return static_cast<size_t>(p - buffer);
+    }
+
+    struct Stats
+    {
+        long long rows;
+        size_t bytes;
+        double seconds;
+        Stats() : rows(0), bytes(0), seconds(0.0) {}
+    };
+
+    // Write config.rows rows plus the header to path. Blocks are formatted in parallel, one
+    // per thread, then written in order.
+    bool generate(const Config &config, const string &path, Stats &stats)
+    {
+        if (maxRowBytes(config) > ROW_BYTES)
+        {
+            cout << "Error: Generated rows could be " << maxRowBytes(config) << " bytes long, more than "
+                 << ROW_BYTES << endl;
+            return false;
+        }
+        auto start = chrono::steady_clock::now();
+        ofstream out(path, ios::binary);
+        if (!out)
+        {
+            cout << "Error: Could not write file " << path << endl;
+            return false;
+        }
+        out << HEADER;
+        stats = Stats();
+        stats.bytes = strlen(HEADER);
+
+        unsigned threads = config.threads > 0 ? config.threads : 1;
+        long long blocks = (config.rows + BLOCK_ROWS - 1) / BLOCK_ROWS;
+        char **buffers = new char *[threads];
+        size_t *lengths = new size_t[threads];
+        for (unsigned k = 0; k < threads; ++k) buffers[k] = new char[BLOCK_ROWS * ROW_BYTES];
+        {
+            Parallel::ThreadPool pool(threads);
+            for (long long first = 0; first < blocks && out; first += threads)
+            {
+                unsigned batch = blocks - first < threads ? static_cast<unsigned>(blocks - first) : threads;
+                {
+                    Parallel::TaskGroup group(pool);
+                    for (unsigned k = 0; k < batch; ++k)
+                        group.run([&config, buffers, lengths, first, k]() {
+                            lengths[k] = generateBlock(config, first + k, buffers[k]);
+                        });
+                }
+                for (unsigned k = 0; k < batch; ++k)
+                {
+                    out.write(buffers[k], static_cast<streamsize>(lengths[k]));
+                    stats.bytes += lengths[k];
+                }
+            }
+        }
+        for (unsigned k = 0; k < threads; ++k) delete[] buffers[k];
+        delete[] buffers;
+        delete[] lengths;
+
+        out.close();
+        if (!out)
+        {
+            cout << "Error: Failed while writing " << path << endl;
+            return false;
+        }
+        stats.rows = config.rows;
+        stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        return true;
+    }
+
+    void printStats(const Stats &stats, const string &path)
+    {
+        double seconds = stats.seconds > 0 ? stats.seconds : 1e-9;
+        cout << "Generated " << stats.rows << " rows (" << fixed << setprecision(1)
+             << stats.bytes / (1024.0 * 1024.0) << " MB) into " << path << " in " << setprecision(2) << stats.seconds
+             << " s: " << setprecision(0) << stats.rows / seconds << " rows/s" << endl;
+    }
+
+    // --- COMMAND LINE ---
+
+    // Parse a row count with an optional K or M suffix
+    bool parseRows(const string &text, long long &rows)
+    {
+        if (text.empty()) return false;
+        long long scale = 1;
+        size_t digits = text.size();
+        char suffix = text[digits - 1];
+        if (suffix == 'K' || suffix == 'k') scale = 1000;
+        else if (suffix == 'M' || suffix == 'm') scale = 1000000;
+        if (scale != 1) --digits;
+        from_chars_result parsed = from_chars(text.data(), text.data() + digits, rows);
+        if (digits == 0 || parsed.ec != errc() || parsed.ptr != text.data() + digits || rows <= 0) return false;
+        rows *= scale;
+        return true;
+    }
+
+    // Apply one of the shared generator options. Returns false if key is not a generator
+    // option; sets valid to false if it is one but the value does not parse.
+    bool parseOption(const string &key, const string &value, Config &config, bool &valid)
+    {
+        valid = true;
+        if (key == "--seed")
+        {
+            const char *end = value.data() + value.size();
+            from_chars_result parsed = from_chars(value.data(), end, config.seed);
+            valid = !value.empty() && parsed.ec == errc() && parsed.ptr == end;
+        }
+        else if (key == "--fraud-rate")
+        {
+            const char *end = value.data() + value.size();
+            double rate = 0;
+            from_chars_result parsed = from_chars(value.data(), end, rate);
+            valid = !value.empty() && parsed.ec == errc() && parsed.ptr == end && rate >= 0 && rate <= 1;
+            if (valid) config.fraudRate = rate;
+        }
+        else if (key == "--types") valid = config.transactionTypes.parse(value);
+        else if (key == "--categories") valid = config.merchantCategories.parse(value);
+        else if (key == "--locations") valid = config.locations.parse(value);
+        else if (key == "--devices") valid = config.devices.parse(value);
+        else if (key == "--channels") valid = config.channels.parse(value);
+        else if (key == "--fraud-types") valid = config.fraudTypes.parse(value);
+        else if (key == "--amount") valid = config.amount.parse(value) && config.amount.low >= 0;
+        else if (key == "--time-since-last") valid = config.timeSinceLast.parse(value);
+        else if (key == "--spending") valid = config.spendingDeviation.parse(value);
+        else if (key == "--velocity") valid = config.velocity.parse(value);
+        else if (key == "--geo") valid = config.geoAnomaly.parse(value);
+        else return false;
+        if (valid && maxRowBytes(config) > ROW_BYTES)
+        {
+            cerr << "Generated rows could be " << maxRowBytes(config) << " bytes long, more than " << ROW_BYTES << endl;
+            valid = false;
+        }
+        return true;
+    }
+
+    void printOptions(ostream &out)
+    {
+        out << "  --seed=N                      generator seed (default 42)\n"
+            << "  --fraud-rate=F                share of fraudulent rows, 0..1 (default 0.036)\n"
+            << "  --types=, --categories=, --locations=, --devices=, --channels=, --fraud-types=LIST\n"
+            << "                                values with optional weights, e.g. card:2,ACH:1,UPI:1\n"
+            << "  --amount=, --time-since-last=, --spending=, --velocity=, --geo=MIN:MAX\n"
+            << "                                ranges of the numeric columns, at most 15 digits\n"
+            << "                                with the 2 decimals (6 for --time-since-last, 0 for --velocity)\n";
+    }
+}
+
+//==================================================================================
+// LINKED LIST IMPLEMENTATION
+//==================================================================================
+
+namespace LinkedList {
+    // Node structure for the Linked List
+    struct Node
+    {
+        Transaction data;
+        Node *next;
+        explicit Node(Transaction &&t) : data(move(t)), next(nullptr) {}
+        // Default constructor for dummy node
+        Node() : next(nullptr) {}
+    };
+
+    // Slab allocator for list nodes. Nodes are carved from large blocks, so a list's
+    // nodes sit next to each other in memory and teardown frees whole blocks instead of
+    // deleting nodes one at a time.
+    class NodeArena
+    {
+    public:
+        static const int NODES_PER_BLOCK = 1024;
+
+        NodeArena() : blocks(nullptr), nodeCount(0), blockCount(0) {}
+        ~NodeArena() { release(); }
+
+        // Construct a node in place, moving the transaction into it
+        Node *allocate(Transaction &&t)
+        {
+            if (blocks == nullptr || blocks->used == NODES_PER_BLOCK)
+            {
+                Block *block = new Block;
+                block->next = blocks;
+                block->used = 0;
+                blocks = block;
+                blockCount++;
+            }
+            Node *node = new (blocks->slot(blocks->used)) Node(move(t));
+            blocks->used++;
+            nodeCount++;
+            return node;
+        }
+
+        // Take over all blocks of another arena (used when merging loader chunks)
+        void splice(NodeArena &other)
+        {
+            if (other.blocks == nullptr) return;
+            Block *last = other.blocks;
+            while (last->next != nullptr) last = last->next;
+            last->next = blocks;
+            blocks = other.blocks;
+            nodeCount += other.nodeCount;
+            blockCount += other.blockCount;
+            other.blocks = nullptr;
+            other.nodeCount = other.blockCount = 0;
+        }
+
+        // Destroy every node and free the blocks
+        void release()
+        {
+            while (blocks != nullptr)
+            {
+                Block *next = blocks->next;
+                for (int i = 0; i < blocks->used; ++i) blocks->slot(i)->~Node();
+                delete blocks;
+                blocks = next;
+            }
+            nodeCount = blockCount = 0;
+        }
+
+        size_t nodes() const { return nodeCount; }
+        size_t blockAllocations() const { return blockCount; }
+        size_t freeSlots() const { return blockCount * NODES_PER_BLOCK - nodeCount; }
+        size_t headerBytes() const { return blockCount * (sizeof(Block) - sizeof(Block::storage)); }
+
+    private:
+        struct Block
+        {
+            Block *next;
+            int used;
+            alignas(Node) unsigned char storage[NODES_PER_BLOCK * sizeof(Node)];
+            Node *slot(int i) { return reinterpret_cast<Node *>(storage) + i; }
+        };
+        Block *blocks; // Most recently allocated first
+        size_t nodeCount;
+        size_t blockCount;
+
+        NodeArena(const NodeArena &);
+        NodeArena &operator=(const NodeArena &);
+    };
+
+    // Transaction type code -> nodes of that type, in list order
+    typedef Index::PostingIndex<Node *> TypeIndex;
+    typedef Index::MatchSet<Node *> MatchSet;
+
+    // The list of one payment channel with its node storage and type index
+    struct Channel
+    {
+        Node *head;
+        NodeArena nodes;
+        TypeIndex types;
+        Memory::Usage memory;    // Measured after loading and after sorting
+        size_t buildAllocations; // Heap allocations counted while the rows were inserted
+        Channel() : head(nullptr), buildAllocations(0) {}
+    };
+
+    // One list per payment channel, indexed by the channel's dictionary code
+    typedef Categories::Partitions<Channel> ChannelLists;
+
+    // Insert at the head of the list, taking the node from the list's arena
+    void insert(Node *&head, NodeArena &arena, Transaction &&t)
+    {
+        Node *newNode = arena.allocate(move(t));
+        newNode->next = head;
+        head = newNode;
+    }
+
+    // Index every node of a list by its transaction type
+    void buildTypeIndex(Node *head, TypeIndex &index)
+    {
+        int count = 0;
+        for (Node *current = head; current != nullptr; current = current->next) count++;
+        index.build(Categories::dictionaries[Categories::TRANSACTION_TYPE].size(), count, [head](auto visit) {
+            for (Node *current = head; current != nullptr; current = current->next)
+                visit(current, current->data.transaction_type);
+        });
+    }
+
+    // Search by transaction type through the inverted index (O(matches), no list walk)
+    MatchSet searchByTransactionType(const TypeIndex &index, const string &type)
+    {
+        return index.match(Categories::dictionaries[Categories::TRANSACTION_TYPE].find(type));
+    }
+
+    // Helper to find the middle of the linked list
+    Node *findMiddle(Node *head)
+    {
+        if (head == nullptr || head->next == nullptr) return head;
+        Node *low = head, *high = head, *prev = nullptr;
+        while (high != nullptr && high->next != nullptr)
+        {
+            prev = low;
+            low = low->next;
+            high = high->next->next;
+        }
+        if (prev) prev->next = nullptr;
+        return low;
+    }
+
+    // Helper to merge two sorted linked lists
+    Node *merge(Node *left, Node *right)
+    {
+        if (!left) return right;
+        if (!right) return left;
+        Node dummyNode;
+        Node *tail = &dummyNode;
+        while (left && right)
+        {
+            if (left->data.location <= right->data.location)
+            {
+                tail->next = left;
+                left = left->next;
+            }
+            else
+            {
+                tail->next = right;
+                right = right->next;
+            }
+            tail = tail->next;
+        }
+        tail->next = left ? left : right;
+        return dummyNode.next;
+    }
+    
+    // Merge sort for the linked list
+    Node *mergeSortByLocation(Node *head)
+    {
+        if (head == nullptr || head->next == nullptr) return head;
+        Node *middle = findMiddle(head);
+        Node *left = head;
+        Node *right = middle;
+        
+        left = mergeSortByLocation(left);
+        right = mergeSortByLocation(right);
+        
+        return merge(left, right);
+    }
+
+    // Bottom-up merge sort with an array of bins: bin i holds a sorted run of 2^i nodes.
+    // Each node is carried into the bins like a binary counter increment, then the bins
+    // are merged together. No middle-finding walks and no recursion; stable like the
+    // recursive version.
+    Node *bottomUpMergeSortByLocation(Node *head)
+    {
+        const int BIN_COUNT = 64;
+        Node *bins[BIN_COUNT] = {nullptr};
+        int usedBins = 0;
+        while (head != nullptr)
+        {
+            Node *run = head;
+            head = head->next;
+            run->next = nullptr;
+            int i = 0;
+            for (; i < BIN_COUNT - 1 && bins[i] != nullptr; ++i)
+            {
+                run = merge(bins[i], run); // Bins hold earlier nodes, so they go on the left
+                bins[i] = nullptr;
+            }
+            bins[i] = run;
+            if (i >= usedBins) usedBins = i + 1;
+        }
+        Node *result = nullptr;
+        for (int i = 0; i < usedBins; ++i) result = merge(bins[i], result);
+        return result;
+    }
+
+    // Node order of a list, saved so the list can be relinked into that order later
+    class ListOrder
+    {
+    public:
+        explicit ListOrder(Node *head) : order(nullptr), count(0)
+        {
+            for (Node *current = head; current != nullptr; current = current->next) count++;
+            order = new Node *[count > 0 ? count : 1];
+            int i = 0;
+            for (Node *current = head; current != nullptr; current = current->next) order[i++] = current;
+        }
+        ~ListOrder() { delete[] order; }
+
+        int size() const { return count; }
+
+        // Relink the nodes in the saved order and return the head
+        Node *restore() const
+        {
+            if (count == 0) return nullptr;
+            for (int k = 0; k + 1 < count; ++k) order[k]->next = order[k + 1];
+            order[count - 1]->next = nullptr;
+            return order[0];
+        }
+
+    private:
+        Node **order;
+        int count;
+        ListOrder(const ListOrder &);
+        ListOrder &operator=(const ListOrder &);
+    };
+
+    // Time the recursive and the bottom-up sort on the same input order. The list is
+    // relinked into its original order before each run, so the benchmark leaves it as it was.
+    void compareSortAlgorithms(Node *&head)
+    {
+        ListOrder original(head);
+        int count = original.size();
+        if (count == 0) return;
+        auto restore = [&](int) { head = original.restore(); };
+
+        Timing::Stats recursive = Timing::measure(restore, [&]() { head = mergeSortByLocation(head); });
+        Timing::Stats bottomUp = Timing::measure(restore, [&]() { head = bottomUpMergeSortByLocation(head); });
+        head = original.restore();
+
+        ostringstream speedup;
+        speedup << fixed << setprecision(2) << (bottomUp.medianNs > 0.0 ? recursive.medianNs / bottomUp.medianNs : 0.0) << "x";
+        cout << "\n+------------------------- SORT COMPARISON (LINKED LIST) ---------------------------+" << endl;
+        cout << "| Nodes             | " << setw(60) << left << count << "|\n";
+        cout << "| Runs              | " << setw(60) << left
+             << (to_string(recursive.runs) + " measured + " + to_string(recursive.warmup) + " warm-up, median shown") << "|\n";
+        cout << "| Recursive         | " << setw(60) << left << Timing::format(recursive.medianNs) << "|\n";
+        cout << "| Bottom-Up         | " << setw(60) << left << Timing::format(bottomUp.medianNs) << "|\n";
+        cout << "| Speedup           | " << setw(60) << left << speedup.str() << "|\n";
+        cout << "+----------------------------------------------------------------------------------+" << endl;
+    }
+
+    // Route a parsed transaction to the list of its channel code
+    void insertByChannel(ChannelLists &channels, Transaction &&t, const Categories::CategorySet &)
+    {
+        if (t.payement_channel == Categories::NO_CODE) return;
+        Channel &channel = channels.partition(t.payement_channel);
+        insert(channel.head, channel.nodes, move(t));
+    }
+
+    // Move the lists of a later chunk in front of the lists built so far, translating
+    // their category codes on the way. Insertion is at the head, so later rows must come
+    // first, as in a serial load.
+    void mergePartial(ChannelLists &channels, ChannelLists &partial, const Categories::CodeRemap &remap)
+    {
+        auto prepend = [&remap](Node *&head, Node *&chunk) {
+            if (chunk == nullptr) return;
+            Node *tail = chunk;
+            CsvLoader::remapCategories(tail->data, remap);
+            while (tail->next != nullptr)
+            {
+                tail = tail->next;
+                CsvLoader::remapCategories(tail->data, remap);
+            }
+            tail->next = head;
+            head = chunk;
+            chunk = nullptr;
+        };
+        for (int code = 0; code < partial.size(); ++code)
+        {
+            Channel &from = partial[code];
+            Categories::Code shared = remap.map(Categories::PAYMENT_CHANNEL, static_cast<Categories::Code>(code));
+            if (from.head == nullptr || shared == Categories::NO_CODE) continue;
+            Channel &to = channels.partition(shared);
+            prepend(to.head, from.head);
+            to.nodes.splice(from.nodes);
+        }
+    }
+
+    // Memory of one list: Transaction bytes, links/padding and arena block headers, string
+    // heap buffers, and the unused slots of the arena blocks
+    Memory::Usage calculateMemoryUsage(Node *head, const NodeArena &arena)
+    {
+        Memory::Usage usage;
+        for (Node *current = head; current != nullptr; current = current->next)
+            usage.stringPayload += Memory::stringPayload(current->data);
+        usage.rowBytes = arena.nodes() * sizeof(Transaction);
+        usage.nodeOverhead = arena.nodes() * (sizeof(Node) - sizeof(Transaction)) + arena.headerBytes();
+        usage.containerSlack = arena.freeSlots() * sizeof(Node);
+        return usage;
+    }
+
+    // Index the filled lists by transaction type and measure them
+    void finishLoading(ChannelLists &channels)
+    {
+        for (int code = 0; code < channels.size(); ++code)
+        {
+            Channel &channel = channels[code];
+            buildTypeIndex(channel.head, channel.types);
+            channel.memory = calculateMemoryUsage(channel.head, channel.nodes);
+        }
+    }
+
+    // Read CSV, populate the linked lists, index them by transaction type and measure them
+    bool readCSV(const string &filename, ChannelLists &channels, CsvLoader::LoadStats &stats)
+    {
+        size_t allocationsBefore = Memory::allocationCount.load();
+        if (!CsvLoader::load(filename, channels, stats, insertByChannel, mergePartial)) return false;
+        stats.allocations = Memory::allocationCount.load() - allocationsBefore;
+        CsvLoader::printLoadStats(stats);
+        finishLoading(channels);
+        return true;
+    }
+    
+    // Export search results to JSON, streaming only the matched nodes
+    void exportSearchResultsToJson(const MatchSet &matches, const string &type, const Timing::Stats &timing, const Memory::Usage &memory)
+    {
+        JsonOutput::Writer out("search_results_list.json");
+        out.beginObject();
+        out.field("operation", "search");
+        out.field("data_structure", "linked_list");
+        out.field("search_type", type);
+        Timing::writeJson(out, timing);
+        Memory::writeJson(out, memory);
+        out.key("matches");
+        out.beginArray();
+        for (int m = 0; m < matches.size(); ++m)
+        {
+            const Transaction &t = matches[m]->data;
+            out.beginObject();
+            out.field("id", t.id);
+            out.field("amount", t.amount);
+            out.field("location", Categories::name(Categories::LOCATION, t.location));
+            out.field("is_fraud", t.is_fraud);
+            out.endObject();
+        }
+        out.endArray();
+        out.endObject();
+    }
+
+    // Export sort results to JSON, one record at a time
+    void exportSortResultsToJson(Node *head, const Timing::Stats &timing, const Memory::Usage &memory)
+    {
+        JsonOutput::Writer out("sort_results_list.json");
+        out.beginObject();
+        out.field("operation", "location_sort");
+        out.field("data_structure", "linked_list");
+        Timing::writeJson(out, timing);
+        Memory::writeJson(out, memory);
+        out.key("sorted_transactions");
+        out.beginArray();
+        for (const Node *current = head; current != nullptr; current = current->next)
+        {
+            out.beginObject();
+            out.field("id", current->data.id);
+            out.field("location", Categories::name(Categories::LOCATION, current->data.location));
+            out.endObject();
+        }
+        out.endArray();
+        out.endObject();
+    }
+    
+    // Describe the node allocations of one list for the metrics table, with the heap
+    // allocations counted by the allocation hook while its rows were inserted
+    string describeAllocations(const Channel &channel)
+    {
+        string text = to_string(channel.nodes.blockAllocations()) + " block allocs for " + to_string(channel.nodes.nodes()) +
+                      " nodes";
+#ifndef FRAUD_NO_ALLOC_HOOK
+        text += ", " + to_string(channel.buildAllocations) + " heap allocs measured";
+#endif
+        return text;
+    }
+
+    // Deallocate all nodes in the lists, one block at a time
+    void cleanup(ChannelLists &channels) {
+        for (int code = 0; code < channels.size(); ++code)
+        {
+            channels[code].types.clear();
+            channels[code].nodes.release();
+            channels[code].head = nullptr;
+        }
+        channels.clear();
+    }
+}
+
+
+//==================================================================================
+// ARRAY IMPLEMENTATION
+//==================================================================================
+
+namespace DynamicArray {
+
+    struct TransactionArray
+    {
+        Transaction *data;
+        int size;
+        int capacity;
+        TransactionArray() : data(nullptr), size(0), capacity(0) {}
+    };
+
+    // Transaction type code -> positions in the array, in ascending order
+    typedef Index::PostingIndex<int> TypeIndex;
+    typedef Index::MatchSet<int> MatchSet;
+
+    // The array of one payment channel with its type index
+    struct Channel
+    {
+        TransactionArray rows;
+        TypeIndex types;
+        Memory::Usage memory; // Measured after loading and after sorting
+    };
+
+    // One array per payment channel, indexed by the channel's dictionary code
+    typedef Categories::Partitions<Channel> ChannelArrays;
+
+    // Make room for at least required rows. Growth moves the existing rows, so their
+    // strings are never copied.
+    void reserve(TransactionArray &arr, int required)
+    {
+        if (required <= arr.capacity) return;
+        int new_capacity = (arr.capacity == 0) ? 10 : arr.capacity * 2;
+        if (new_capacity < required) new_capacity = required;
+        Transaction *new_data = new Transaction[new_capacity];
+        for (int i = 0; i < arr.size; ++i)
+        {
+            new_data[i] = move(arr.data[i]);
+        }
+        delete[] arr.data;
+        arr.data = new_data;
+        arr.capacity = new_capacity;
+    }
+
+    // Move a transaction into a dynamic array, resizing if necessary
+    void insert(TransactionArray &arr, Transaction &&t)
+    {
+        reserve(arr, arr.size + 1);
+        arr.data[arr.size++] = move(t);
+    }
+    
+    // Index every position of an array by its transaction type. Positions change when the
+    // array is sorted, so the index is rebuilt after every sort.
+    void buildTypeIndex(const TransactionArray &arr, TypeIndex &index)
+    {
+        index.build(Categories::dictionaries[Categories::TRANSACTION_TYPE].size(), arr.size, [&arr](auto visit) {
+            for (int i = 0; i < arr.size; ++i) visit(i, arr.data[i].transaction_type);
+        });
+    }
+
+    // Search by transaction type through the inverted index (O(matches), no array scan)
+    MatchSet searchByTransactionType(const TypeIndex &index, const string &type)
+    {
+        return index.match(Categories::dictionaries[Categories::TRANSACTION_TYPE].find(type));
+    }
+
+    // Helper to merge two sorted subarrays. Only the left run is moved out to the scratch
+    // buffer; the right run is merged in place behind it.
+    void merge(Transaction *array, Transaction *scratch, int const left, int const mid, int const right)
+    {
+        int const subArrayOne = mid - left + 1;
+        for (int i = 0; i < subArrayOne; i++) scratch[i] = move(array[left + i]);
+        int i = 0, j = mid + 1, k = left;
+        while (i < subArrayOne && j <= right)
+        {
+            if (scratch[i].location <= array[j].location) array[k++] = move(scratch[i++]);
+            else array[k++] = move(array[j++]);
+        }
+        while (i < subArrayOne) array[k++] = move(scratch[i++]);
+    }
+
+    // Recursive merge sort over array[begin..end] sharing one scratch buffer
+    void mergeSortRange(Transaction *array, Transaction *scratch, int const begin, int const end)
+    {
+        if (begin >= end) return;
+        int mid = begin + (end - begin) / 2;
+        mergeSortRange(array, scratch, begin, mid);
+        mergeSortRange(array, scratch, mid + 1, end);
+        if (array[mid].location <= array[mid + 1].location) return; // Runs already in order
+        merge(array, scratch, begin, mid, end);
+    }
+
+    // Merge sort main function for an array. The scratch buffer is allocated once per sort
+    // and elements are moved, never copied.
+    void mergeSortByLocation(Transaction *array, int const begin, int const end)
+    {
+        if (begin >= end) return;
+        Transaction *scratch = new Transaction[(end - begin) / 2 + 1];
+        mergeSortRange(array, scratch, begin, end);
+        delete[] scratch;
+    }
+    
+    // Threads used by the array sort; 1 keeps the serial merge sort
+    unsigned sortThreads = Parallel::hardwareThreads();
+
+    // Ranges at or below this size are sorted serially, and merges are split into pieces
+    // of roughly this many elements
+    const int SORT_GRAIN = 4096;
+
+    // Stable merge-path split: how many of the first k outputs of merging a (n1 elements)
+    // with b (n2 elements) come from a. Equal keys are taken from a first.
+    int coRank(int k, const Transaction *a, int n1, const Transaction *b, int n2)
+    {
+        int lo = k > n2 ? k - n2 : 0;
+        int hi = k < n1 ? k : n1;
+        while (lo < hi)
+        {
+            int i = lo + (hi - lo) / 2;
+            int j = k - i;
+            if (j > 0 && i < n1 && !(b[j - 1].location < a[i].location)) lo = i + 1;
+            else hi = i;
+        }
+        return lo;
+    }
+
+    // Stable merge of a and b into out, moving the elements
+    void mergeInto(Transaction *a, int n1, Transaction *b, int n2, Transaction *out)
+    {
+        int i = 0, j = 0, k = 0;
+        while (i < n1 && j < n2)
+        {
+            if (a[i].location <= b[j].location) out[k++] = move(a[i++]);
+            else out[k++] = move(b[j++]);
+        }
+        while (i < n1) out[k++] = move(a[i++]);
+        while (j < n2) out[k++] = move(b[j++]);
+    }
+
+    // Merge a and b into out as independent pieces, each bounded by co-rank splits
+    void parallelMerge(Parallel::ThreadPool &pool, Transaction *a, int n1, Transaction *b, int n2, Transaction *out)
+    {
+        int total = n1 + n2;
+        int pieces = total / SORT_GRAIN;
+        int maxPieces = static_cast<int>(pool.threads()) * 4;
+        if (pieces > maxPieces) pieces = maxPieces;
+        if (pieces < 2)
+        {
+            mergeInto(a, n1, b, n2, out);
+            return;
+        }
+        Parallel::TaskGroup group(pool);
+        for (int p = 0; p < pieces; ++p)
+        {
+            int k0 = static_cast<int>(static_cast<long long>(total) * p / pieces);
+            int k1 = static_cast<int>(static_cast<long long>(total) * (p + 1) / pieces);
+            group.run([=]() {
+                int i0 = coRank(k0, a, n1, b, n2);
+                int i1 = coRank(k1, a, n1, b, n2);
+                mergeInto(a + i0, i1 - i0, b + (k0 - i0), (k1 - i1) - (k0 - i0), out + k0);
+            });
+        }
+        group.wait();
+    }
+
+    // Sort src[0..n). The result lands in dst when intoDst is set, otherwise back in src;
+    // the other buffer is used as scratch, so levels alternate between the two buffers.
+    void parallelSortRange(Parallel::ThreadPool &pool, Transaction *src, Transaction *dst, int n, bool intoDst)
+    {
+        if (n <= SORT_GRAIN)
+        {
+            mergeSortRange(src, dst, 0, n - 1);
+            if (intoDst)
+                for (int i = 0; i < n; ++i) dst[i] = move(src[i]);
+            return;
+        }
+        int half = n / 2;
+        Parallel::TaskGroup group(pool);
+        group.run([=, &pool]() { parallelSortRange(pool, src, dst, half, !intoDst); });
+        parallelSortRange(pool, src + half, dst + half, n - half, !intoDst);
+        group.wait();
+        if (intoDst) parallelMerge(pool, src, half, src + half, n - half, dst);
+        else parallelMerge(pool, dst, half, dst + half, n - half, src);
+    }
+
+    // Parallel merge sort for an array: both halves are forked on a thread pool down to
+    // SORT_GRAIN elements and merges are split by co-rank, so the top-level merges run in
+    // parallel too. The result is identical to mergeSortByLocation.
+    void parallelMergeSortByLocation(Transaction *array, int size, unsigned threads)
+    {
+        if (size < 2) return;
+        Parallel::ThreadPool pool(threads);
+        Transaction *scratch = new Transaction[size];
+        parallelSortRange(pool, array, scratch, size, false);
+        delete[] scratch;
+    }
+
+    // Sort one channel array by location, on sortThreads threads when more than one
+    void sortByLocation(TransactionArray &arr)
+    {
+        if (sortThreads > 1)
+            parallelMergeSortByLocation(arr.data, arr.size, sortThreads);
+        else if (arr.size > 1)
+            mergeSortByLocation(arr.data, 0, arr.size - 1);
+    }
+    
+    // Copy of an array's rows
+    TransactionArray copyOf(const TransactionArray &arr)
+    {
+        TransactionArray copy;
+        copy.data = new Transaction[arr.size > 0 ? arr.size : 1];
+        copy.size = copy.capacity = arr.size;
+        for (int i = 0; i < arr.size; ++i) copy.data[i] = arr.data[i];
+        return copy;
+    }
+
+    // Undo a sort in place: row i goes back to position order[i]. Rows move along the
+    // cycles of the permutation, so nothing is copied.
+    void unsort(TransactionArray &arr, const int *order)
+    {
+        bool *placed = new bool[arr.size > 0 ? arr.size : 1]();
+        for (int start = 0; start < arr.size; ++start)
+        {
+            if (placed[start]) continue;
+            Transaction carried = move(arr.data[start]);
+            for (int i = start; !placed[i]; i = order[i])
+            {
+                placed[i] = true;
+                swap(carried, arr.data[order[i]]);
+            }
+        }
+        delete[] placed;
+    }
+
+    // Route a parsed transaction to the array of its channel code
+    void insertByChannel(ChannelArrays &channels, Transaction &&t, const Categories::CategorySet &)
+    {
+        if (t.payement_channel == Categories::NO_CODE) return;
+        insert(channels.partition(t.payement_channel).rows, move(t));
+    }
+
+    // Make room for more rows of a channel (their number is known before a snapshot load)
+    void reserveByChannel(ChannelArrays &channels, Categories::Code channel, size_t rows)
+    {
+        TransactionArray &arr = channels.partition(channel).rows;
+        reserve(arr, arr.size + static_cast<int>(rows));
+    }
+
+    // Append the arrays of a later chunk to the arrays built so far, translating their
+    // category codes on the way
+    void mergePartial(ChannelArrays &channels, ChannelArrays &partial, const Categories::CodeRemap &remap)
+    {
+        auto append = [&remap](TransactionArray &arr, TransactionArray &chunk) {
+            if (chunk.size == 0) return;
+            for (int i = 0; i < chunk.size; ++i) CsvLoader::remapCategories(chunk.data[i], remap);
+            if (arr.size == 0)
+            {
+                // First non-empty chunk: take over its buffer
+                delete[] arr.data;
+                arr = chunk;
+            }
+            else
+            {
+                int new_capacity = arr.size + chunk.size;
+                Transaction *new_data = new Transaction[new_capacity];
+                for (int i = 0; i < arr.size; ++i) new_data[i] = move(arr.data[i]);
+                for (int i = 0; i < chunk.size; ++i) new_data[arr.size + i] = move(chunk.data[i]);
+                delete[] arr.data;
+                delete[] chunk.data;
+                arr.data = new_data;
+                arr.size = new_capacity;
+                arr.capacity = new_capacity;
+            }
+            chunk = TransactionArray();
+        };
+        for (int code = 0; code < partial.size(); ++code)
+        {
+            Categories::Code shared = remap.map(Categories::PAYMENT_CHANNEL, static_cast<Categories::Code>(code));
+            if (partial[code].rows.size == 0 || shared == Categories::NO_CODE) continue;
+            append(channels.partition(shared).rows, partial[code].rows);
+        }
+    }
+
+    // Calculate memory usage for an array based on its size
+    Memory::Usage calculateMemoryUsage(const TransactionArray &arr)
+    {
+        Memory::Usage usage;
+        for (int i = 0; i < arr.size; ++i) usage.stringPayload += Memory::stringPayload(arr.data[i]);
+        usage.rowBytes = static_cast<size_t>(arr.size) * sizeof(Transaction);
+        usage.containerSlack = static_cast<size_t>(arr.capacity - arr.size) * sizeof(Transaction);
+        return usage;
+    }
+
+    // Index the filled arrays by transaction type and measure them
+    void finishLoading(ChannelArrays &channels)
+    {
+        for (int code = 0; code < channels.size(); ++code)
+        {
+            Channel &channel = channels[code];
+            buildTypeIndex(channel.rows, channel.types);
+            channel.memory = calculateMemoryUsage(channel.rows);
+        }
+    }
+
+    // Read CSV, populate the arrays, index them by transaction type and measure them
+    bool readCSV(const string &filename, ChannelArrays &channels, CsvLoader::LoadStats &stats)
+    {
+        size_t allocationsBefore = Memory::allocationCount.load();
+        if (!CsvLoader::load(filename, channels, stats, insertByChannel, mergePartial, reserveByChannel)) return false;
+        stats.allocations = Memory::allocationCount.load() - allocationsBefore;
+        CsvLoader::printLoadStats(stats);
+        finishLoading(channels);
+        return true;
+    }
+    
+    // Export search results to JSON, streaming only the matched positions
+    void exportSearchResultsToJson(const TransactionArray &arr, const MatchSet &matches, const string &type, const Timing::Stats &timing, const Memory::Usage &memory)
+    {
+        JsonOutput::Writer out("search_results_array.json");
+        out.beginObject();
+        out.field("operation", "search");
+        out.field("data_structure", "array");
+        out.field("search_type", type);
+        Timing::writeJson(out, timing);
+        Memory::writeJson(out, memory);
+        out.key("matches");
+        out.beginArray();
+        for (int m = 0; m < matches.size(); ++m)
+        {
+            const Transaction &t = arr.data[matches[m]];
+            out.beginObject();
+            out.field("id", t.id);
+            out.field("amount", t.amount);
+            out.field("location", Categories::name(Categories::LOCATION, t.location));
+            out.field("is_fraud", t.is_fraud);
+            out.endObject();
+        }
+        out.endArray();
+        out.endObject();
+    }
+
+    // Export sort results to JSON, one record at a time
+    void exportSortResultsToJson(const TransactionArray &arr, const Timing::Stats &timing, const Memory::Usage &memory)
+    {
+        JsonOutput::Writer out("sort_results_array.json");
+        out.beginObject();
+        out.field("operation", "location_sort");
+        out.field("data_structure", "array");
+        Timing::writeJson(out, timing);
+        Memory::writeJson(out, memory);
+        out.key("sorted_transactions");
+        out.beginArray();
+        for (int i = 0; i < arr.size; ++i)
+        {
+            out.beginObject();
+            out.field("id", arr.data[i].id);
+            out.field("location", Categories::name(Categories::LOCATION, arr.data[i].location));
+            out.endObject();
+        }
+        out.endArray();
+        out.endObject();
+    }
+    
+    // Deallocate all dynamic arrays
+    void cleanup(ChannelArrays &channels)
+    {
+        for (int code = 0; code < channels.size(); ++code)
+        {
+            channels[code].types.clear();
+            delete[] channels[code].rows.data;
+            channels[code].rows = TransactionArray();
+        }
+        channels.clear();
+    }
+}
+
+
+//==================================================================================
+// COLUMNAR IMPLEMENTATION
+//==================================================================================
+
+namespace Columnar {
+
+    // Struct-of-arrays store: each of the 18 CSV fields lives in its own contiguous
+    // column, so a scan over one field only touches that field's memory.
+    struct ColumnStore
+    {
+        string *id;
+        string *timestamp;
+        string *sender_account;
+        string *reciver_amount;
+        float *amount;
+        Categories::Code *transaction_type;
+        Categories::Code *merchant_category;
+        Categories::Code *location;
+        Categories::Code *device_used;
+        bool *is_fraud;
+        Categories::Code *fraud_type;
+        double *time_since_last_transaction;
+        double *spending_deviation_score;
+        double *velocity_score;
+        double *geo_anomaly_score;
+        Categories::Code *payement_channel;
+        string *ip_address;
+        string *device_hash;
+        int size;
+        int capacity;
+        ColumnStore()
+            : id(nullptr), timestamp(nullptr), sender_account(nullptr), reciver_amount(nullptr), amount(nullptr),
+              transaction_type(nullptr), merchant_category(nullptr), location(nullptr), device_used(nullptr),
+              is_fraud(nullptr), fraud_type(nullptr), time_since_last_transaction(nullptr),
+              spending_deviation_score(nullptr), velocity_score(nullptr), geo_anomaly_score(nullptr),
+              payement_channel(nullptr), ip_address(nullptr), device_hash(nullptr), size(0), capacity(0) {}
+    };
+
+    // Matching row positions of a search
+    typedef Index::MatchSet<int> MatchSet;
+
+    // Roaring bitmap indexes of one store, one bitmap per value of each indexed column,
+    // built at load time and after every sort
+    struct BitmapIndexes
+    {
+        static const int COUNT = Categories::PAYMENT_CHANNEL + 1; // Indexed columns
+
+        Roaring::ValueIndex categories[Categories::PAYMENT_CHANNEL]; // transaction_type .. fraud_type
+        Roaring::ValueIndex fraud;                                   // is_fraud: false, true
+
+        // The categorical columns in Categories::Column order, then is_fraud
+        const Roaring::ValueIndex &index(int i) const { return i < Categories::PAYMENT_CHANNEL ? categories[i] : fraud; }
+
+        static const char *name(int i)
+        {
+            static const char *const names[COUNT] = {"transaction_type", "merchant_category", "location",
+                                                     "device_used", "fraud_type", "is_fraud"};
+            return names[i];
+        }
+
+        void clear()
+        {
+            for (int c = 0; c < Categories::PAYMENT_CHANNEL; ++c) categories[c].clear();
+            fraud.clear();
+        }
+
+        size_t bytes() const
+        {
+            size_t b = 0;
+            for (int i = 0; i < COUNT; ++i) b += index(i).bytes();
+            return b;
+        }
+    };
+
+    // The column store of one payment channel
+    struct Channel
+    {
+        ColumnStore store;
+        BitmapIndexes indexes;
+        Memory::Usage memory; // Measured after loading and after sorting
+    };
+
+    // One column store per payment channel, indexed by the channel's dictionary code
+    typedef Categories::Partitions<Channel> ChannelColumns;
+
+    // Apply fn to every column of the store
+    template <typename ColumnFunction>
+    void forEachColumn(ColumnStore &store, ColumnFunction fn)
+    {
+        fn(store.id); fn(store.timestamp); fn(store.sender_account); fn(store.reciver_amount);
+        fn(store.amount); fn(store.transaction_type); fn(store.merchant_category); fn(store.location);
+        fn(store.device_used); fn(store.is_fraud); fn(store.fraud_type); fn(store.time_since_last_transaction);
+        fn(store.spending_deviation_score); fn(store.velocity_score); fn(store.geo_anomaly_score);
+        fn(store.payement_channel); fn(store.ip_address); fn(store.device_hash);
+    }
+
+    // Reallocate one column to a new capacity, moving the existing values across
+    template <typename T>
+    void resizeColumn(T *&column, int size, int new_capacity)
+    {
+        T *new_column = new T[new_capacity];
+        for (int i = 0; i < size; ++i) new_column[i] = move(column[i]);
+        delete[] column;
+        column = new_column;
+    }
+
+    // Make room for at least `required` rows
+    void reserve(ColumnStore &store, int required)
+    {
+        if (required <= store.capacity) return;
+        int new_capacity = (store.capacity == 0) ? 10 : store.capacity * 2;
+        if (new_capacity < required) new_capacity = required;
+        int size = store.size;
+        forEachColumn(store, [size, new_capacity](auto *&column) { resizeColumn(column, size, new_capacity); });
+        store.capacity = new_capacity;
+    }
+
+    // Append a transaction, moving its fields into the columns
+    void insert(ColumnStore &store, Transaction &&t)
+    {
+        reserve(store, store.size + 1);
+        int i = store.size++;
+        store.id[i] = move(t.id);
+        store.timestamp[i] = move(t.timestamp);
+        store.sender_account[i] = move(t.sender_account);
+        store.reciver_amount[i] = move(t.reciver_amount);
+        store.amount[i] = t.amount;
+        store.transaction_type[i] = t.transaction_type;
+        store.merchant_category[i] = t.merchant_category;
+        store.location[i] = t.location;
+        store.device_used[i] = t.device_used;
+        store.is_fraud[i] = t.is_fraud;
+        store.fraud_type[i] = t.fraud_type;
+        store.time_since_last_transaction[i] = t.time_since_last_transaction;
+        store.spending_deviation_score[i] = t.spending_deviation_score;
+        store.velocity_score[i] = t.velocity_score;
+        store.geo_anomaly_score[i] = t.geo_anomaly_score;
+        store.payement_channel[i] = t.payement_channel;
+        store.ip_address[i] = move(t.ip_address);
+        store.device_hash[i] = move(t.device_hash);
+    }
+
+    // Index every categorical column (but the channel) and is_fraud of a store
+    void buildIndexes(const ColumnStore &store, BitmapIndexes &indexes)
+    {
+        const Categories::Code *columns[Categories::PAYMENT_CHANNEL] = {
+            store.transaction_type, store.merchant_category, store.location, store.device_used, store.fraud_type};
+        for (int c = 0; c < Categories::PAYMENT_CHANNEL; ++c)
+            indexes.categories[c].build(columns[c], store.size, Categories::dictionaries[c].size());
+        indexes.fraud.build(store.is_fraud, store.size, 2);
+    }
+
+    // Rows of a transaction type, from its bitmap (empty for unknown types)
+    const Roaring::Bitmap &rowsOfType(const BitmapIndexes &indexes, const string &type)
+    {
+        Categories::Code code = Categories::dictionaries[Categories::TRANSACTION_TYPE].find(type);
+        return indexes.categories[Categories::TRANSACTION_TYPE].rows(code == Categories::NO_CODE ? -1 : code);
+    }
+
+    // Number of rows of a transaction type: the bitmap's cardinality, no scan
+    int countByTransactionType(const BitmapIndexes &indexes, const string &type)
+    {
+        return rowsOfType(indexes, type).cardinality();
+    }
+
+    // Search by transaction type: expand the type's bitmap into the matching row positions
+    MatchSet searchByTransactionType(const BitmapIndexes &indexes, const string &type)
+    {
+        const Roaring::Bitmap &rows = rowsOfType(indexes, type);
+        int *positions = new int[rows.cardinality() > 0 ? rows.cardinality() : 1];
+        int matchCount = rows.toPositions(positions);
+        return MatchSet::adopt(positions, matchCount);
+    }
+
+    // Helper to merge two sorted runs of row indices, ordered by location
+    void merge(const Categories::Code *location, int *order, int *scratch, int const left, int const mid, int const right)
+    {
+        for (int i = left; i <= right; ++i) scratch[i] = order[i];
+        int i = left, j = mid + 1, k = left;
+        while (i <= mid && j <= right)
+        {
+            if (location[scratch[i]] <= location[scratch[j]]) order[k++] = scratch[i++];
+            else order[k++] = scratch[j++];
+        }
+        while (i <= mid) order[k++] = scratch[i++];
+        while (j <= right) order[k++] = scratch[j++];
+    }
+
+    // Merge sort of row indices by the location column
+    void mergeSortIndices(const Categories::Code *location, int *order, int *scratch, int const begin, int const end)
+    {
+        if (begin >= end) return;
+        int mid = begin + (end - begin) / 2;
+        mergeSortIndices(location, order, scratch, begin, mid);
+        mergeSortIndices(location, order, scratch, mid + 1, end);
+        merge(location, order, scratch, begin, mid, end);
+    }
+
+    // Reorder one column so that row i becomes old row order[i]
+    template <typename T>
+    void permuteColumn(T *&column, const int *order, int size, int capacity)
+    {
+        T *sorted = new T[capacity];
+        for (int i = 0; i < size; ++i) sorted[i] = move(column[order[i]]);
+        delete[] column;
+        column = sorted;
+    }
+
+    // Sort the store by location: sort only the location column's row order, then
+    // gather every column through that order once
+    void mergeSortByLocation(ColumnStore &store)
+    {
+        if (store.size < 2) return;
+        int *order = new int[store.size];
+        int *scratch = new int[store.size];
+        for (int i = 0; i < store.size; ++i) order[i] = i;
+        mergeSortIndices(store.location, order, scratch, 0, store.size - 1);
+        int size = store.size, capacity = store.capacity;
+        forEachColumn(store, [order, size, capacity](auto *&column) { permuteColumn(column, order, size, capacity); });
+        delete[] scratch;
+        delete[] order;
+    }
+
+    // Route a parsed transaction to the store of its channel code
+    void insertByChannel(ChannelColumns &channels, Transaction &&t, const Categories::CategorySet &)
+    {
+        if (t.payement_channel == Categories::NO_CODE) return;
+        insert(channels.partition(t.payement_channel).store, move(t));
+    }
+
+    // Make room for more rows of a channel (their number is known before a snapshot load)
+    void reserveByChannel(ChannelColumns &channels, Categories::Code channel, size_t rows)
+    {
+        ColumnStore &store = channels.partition(channel).store;
+        reserve(store, store.size + static_cast<int>(rows));
+    }
+
+    // Append one column of a later chunk
+    template <typename T>
+    void appendColumn(T *column, int offset, T *chunk, int count)
+    {
+        for (int i = 0; i < count; ++i) column[offset + i] = move(chunk[i]);
+    }
+
+    // Translate the codes of one categorical column from worker codes to shared codes
+    void remapColumn(Categories::Code *column, int count, Categories::Column category, const Categories::CodeRemap &remap)
+    {
+        for (int i = 0; i < count; ++i) column[i] = remap.map(category, column[i]);
+    }
+
+    // Scatter one column so that row i moves back to position order[i]
+    template <typename T>
+    void unpermuteColumn(T *&column, const int *order, int size, int capacity)
+    {
+        T *restored = new T[capacity];
+        for (int i = 0; i < size; ++i) restored[order[i]] = move(column[i]);
+        delete[] column;
+        column = restored;
+    }
+
+    // Undo a sort: row i goes back to position order[i], one column at a time
+    void unsort(ColumnStore &store, const int *order)
+    {
+        int size = store.size, capacity = store.capacity;
+        forEachColumn(store, [order, size, capacity](auto *&column) { unpermuteColumn(column, order, size, capacity); });
+    }
+
+    // Deallocate every column of a store
+    void release(ColumnStore &store)
+    {
+        forEachColumn(store, [](auto *&column) {
+            delete[] column;
+            column = nullptr;
+        });
+        store.size = 0;
+        store.capacity = 0;
+    }
+
+    // Append the stores of a later chunk to the stores built so far, translating their
+    // category codes on the way
+    void mergePartial(ChannelColumns &channels, ChannelColumns &partial, const Categories::CodeRemap &remap)
+    {
+        auto append = [&remap](ColumnStore &store, ColumnStore &chunk) {
+            if (chunk.size == 0) return;
+            remapColumn(chunk.transaction_type, chunk.size, Categories::TRANSACTION_TYPE, remap);
+            remapColumn(chunk.merchant_category, chunk.size, Categories::MERCHANT_CATEGORY, remap);
+            remapColumn(chunk.location, chunk.size, Categories::LOCATION, remap);
+            remapColumn(chunk.device_used, chunk.size, Categories::DEVICE_USED, remap);
+            remapColumn(chunk.fraud_type, chunk.size, Categories::FRAUD_TYPE, remap);
+            remapColumn(chunk.payement_channel, chunk.size, Categories::PAYMENT_CHANNEL, remap);
+            if (store.size == 0)
+            {
+                // First non-empty chunk: take over its columns
+                release(store);
+                store = chunk;
+                chunk = ColumnStore();
+                return;
+            }
+            int offset = store.size, count = chunk.size;
+            reserve(store, offset + count);
+            appendColumn(store.id, offset, chunk.id, count);
+            appendColumn(store.timestamp, offset, chunk.timestamp, count);
+            appendColumn(store.sender_account, offset, chunk.sender_account, count);
+            appendColumn(store.reciver_amount, offset, chunk.reciver_amount, count);
+            appendColumn(store.amount, offset, chunk.amount, count);
+            appendColumn(store.transaction_type, offset, chunk.transaction_type, count);
+            appendColumn(store.merchant_category, offset, chunk.merchant_category, count);
+            appendColumn(store.location, offset, chunk.location, count);
+            appendColumn(store.device_used, offset, chunk.device_used, count);
+            appendColumn(store.is_fraud, offset, chunk.is_fraud, count);
+            appendColumn(store.fraud_type, offset, chunk.fraud_type, count);
+            appendColumn(store.time_since_last_transaction, offset, chunk.time_since_last_transaction, count);
+            appendColumn(store.spending_deviation_score, offset, chunk.spending_deviation_score, count);
+            appendColumn(store.velocity_score, offset, chunk.velocity_score, count);
+            appendColumn(store.geo_anomaly_score, offset, chunk.geo_anomaly_score, count);
+            appendColumn(store.payement_channel, offset, chunk.payement_channel, count);
+            appendColumn(store.ip_address, offset, chunk.ip_address, count);
+            appendColumn(store.device_hash, offset, chunk.device_hash, count);
+            store.size += count;
+            release(chunk);
+        };
+        for (int code = 0; code < partial.size(); ++code)
+        {
+            Categories::Code shared = remap.map(Categories::PAYMENT_CHANNEL, static_cast<Categories::Code>(code));
+            if (partial[code].store.size == 0 || shared == Categories::NO_CODE) continue;
+            append(channels.partition(shared).store, partial[code].store);
+        }
+    }
+
+    // Calculate memory usage for a column store based on its size, plus its indexes
+    Memory::Usage calculateMemoryUsage(const ColumnStore &store, const BitmapIndexes &indexes)
+    {
+        size_t bytesPerRow = 6 * sizeof(string) + 6 * sizeof(Categories::Code) + sizeof(float) + sizeof(bool) +
+                             4 * sizeof(double);
+        Memory::Usage usage;
+        for (int i = 0; i < store.size; ++i)
+            usage.stringPayload += Memory::stringPayload(store.id[i]) + Memory::stringPayload(store.timestamp[i]) +
+                                   Memory::stringPayload(store.sender_account[i]) + Memory::stringPayload(store.reciver_amount[i]) +
+                                   Memory::stringPayload(store.ip_address[i]) + Memory::stringPayload(store.device_hash[i]);
+        usage.rowBytes = static_cast<size_t>(store.size) * bytesPerRow;
+        usage.containerSlack = static_cast<size_t>(store.capacity - store.size) * bytesPerRow;
+        usage.indexBytes = indexes.bytes();
+        return usage;
+    }
+
+    // Index and measure the filled column stores
+    void finishLoading(ChannelColumns &channels)
+    {
+        for (int code = 0; code < channels.size(); ++code)
+        {
+            Channel &channel = channels[code];
+            buildIndexes(channel.store, channel.indexes);
+            channel.memory = calculateMemoryUsage(channel.store, channel.indexes);
+        }
+    }
+
+    // Read CSV, populate the column stores, index and measure them
+    bool readCSV(const string &filename, ChannelColumns &channels, CsvLoader::LoadStats &stats)
+    {
+        size_t allocationsBefore = Memory::allocationCount.load();
+        if (!CsvLoader::load(filename, channels, stats, insertByChannel, mergePartial, reserveByChannel)) return false;
+        stats.allocations = Memory::allocationCount.load() - allocationsBefore;
+        CsvLoader::printLoadStats(stats);
+        finishLoading(channels);
+        return true;
+    }
+
+    // Write one matched row (with its channel name, if given) as a JSON object
+    void writeMatch(JsonOutput::Writer &out, const ColumnStore &store, int i, const string *channel = nullptr)
+    {
+        out.beginObject();
+        out.field("id", store.id[i]);
+        if (channel) out.field("payement_channel", *channel);
+        out.field("amount", store.amount[i]);
+        out.field("location", Categories::name(Categories::LOCATION, store.location[i]));
+        out.field("is_fraud", store.is_fraud[i]);
+        out.endObject();
+    }
+
+    // Export search results to JSON, streaming only the matched rows
+    void exportSearchResultsToJson(const ColumnStore &store, const MatchSet &matches, const string &type, const Timing::Stats &timing, const Memory::Usage &memory)
+    {
+        JsonOutput::Writer out("search_results_columnar.json");
+        out.beginObject();
+        out.field("operation", "search");
+        out.field("data_structure", "columnar");
+        out.field("search_type", type);
+        Timing::writeJson(out, timing);
+        Memory::writeJson(out, memory);
+        out.key("matches");
+        out.beginArray();
+        for (int m = 0; m < matches.size(); ++m) writeMatch(out, store, matches[m]);
+        out.endArray();
+        out.endObject();
+    }
+
+    // Export sort results to JSON, one record at a time
+    void exportSortResultsToJson(const ColumnStore &store, const Timing::Stats &timing, const Memory::Usage &memory)
+    {
+        JsonOutput::Writer out("sort_results_columnar.json");
+        out.beginObject();
+        out.field("operation", "location_sort");
+        out.field("data_structure", "columnar");
+        Timing::writeJson(out, timing);
+        Memory::writeJson(out, memory);
+        out.key("sorted_transactions");
+        out.beginArray();
+        for (int i = 0; i < store.size; ++i)
+        {
+            out.beginObject();
+            out.field("id", store.id[i]);
+            out.field("location", Categories::name(Categories::LOCATION, store.location[i]));
+            out.endObject();
+        }
+        out.endArray();
+        out.endObject();
+    }
+
+    // Deallocate all column stores
+    void cleanup(ChannelColumns &channels)
+    {
+        for (int code = 0; code < channels.size(); ++code)
+        {
+            release(channels[code].store);
+            channels[code].indexes.clear();
+        }
+        channels.clear();
+    }
+}
+
+//==================================================================================
+// CHANNEL OPERATIONS
+//==================================================================================
+
+// The load, search, sort, export and cleanup steps of each data structure under one set of
+// names, so the menus, the batch runner and the benchmark time them the same way
+
+namespace Backends {
+    // Whether a timed sort needs the unsorted order to restore between runs
+    bool sortRunsRepeat() { return Timing::warmupRuns + Timing::measuredRuns > 1; }
+
+    // Row order a sort by location produces: sorted row i is unsorted row order[i]. Every
+    // location sort is a stable merge sort on the location code, so one counting pass over
+    // the codes predicts it, and a sorted channel can be put back through this permutation
+    // instead of from a copy of its rows.
+    template <typename LocationOf>
+    int *locationOrder(int size, LocationOf locationOf)
+    {
+        int buckets = Categories::dictionaries[Categories::LOCATION].size() + 1; // NO_CODE sorts last
+        int *starts = new int[buckets + 1]();
+        auto bucketOf = [&](int i) {
+            Categories::Code code = locationOf(i);
+            return code == Categories::NO_CODE ? buckets - 1 : static_cast<int>(code);
+        };
+        for (int i = 0; i < size; ++i) starts[bucketOf(i) + 1]++;
+        for (int b = 0; b < buckets; ++b) starts[b + 1] += starts[b];
+        int *order = new int[size > 0 ? size : 1];
+        for (int i = 0; i < size; ++i) order[starts[bucketOf(i)]++] = i;
+        delete[] starts;
+        return order;
+    }
+
+    struct LinkedLists
+    {
+        typedef LinkedList::ChannelLists Channels;
+        typedef LinkedList::Channel Channel;
+        typedef LinkedList::MatchSet MatchSet;
+        static const char *name() { return "list"; }
+
+        // The unsorted node order, relinked before every sort run after the first
+        class SavedOrder
+        {
+        public:
+            explicit SavedOrder(const Channel &channel) : order(channel.head) {}
+            void restore(Channel &channel) const { channel.head = order.restore(); }
+
+        private:
+            LinkedList::ListOrder order;
+        };
+
+        static bool load(const string &path, Channels &channels, CsvLoader::LoadStats &stats)
+        {
+            return LinkedList::readCSV(path, channels, stats);
+        }
+        static int rows(const Channel &channel) { return static_cast<int>(channel.nodes.nodes()); }
+        static MatchSet search(const Channel &channel, const string &type)
+        {
+            return LinkedList::searchByTransactionType(channel.types, type);
+        }
+        static int matchCount(const Channel &, const MatchSet &matches, const string &) { return matches.size(); }
+        static void sort(Channel &channel) { channel.head = LinkedList::bottomUpMergeSortByLocation(channel.head); }
+        // Rebuild the index (postings follow list order) and measure again after a sort
+        static void reindex(Channel &channel)
+        {
+            LinkedList::buildTypeIndex(channel.head, channel.types);
+            channel.memory = LinkedList::calculateMemoryUsage(channel.head, channel.nodes);
+        }
+        static void exportSearch(const Channel &channel, const MatchSet &matches, const string &type, const Timing::Stats &timing)
+        {
+            LinkedList::exportSearchResultsToJson(matches, type, timing, channel.memory);
+        }
+        static void exportSort(const Channel &channel, const Timing::Stats &timing)
+        {
+            LinkedList::exportSortResultsToJson(channel.head, timing, channel.memory);
+        }
+        static void cleanup(Channels &channels) { LinkedList::cleanup(channels); }
+    };
+
+    struct DynamicArrays
+    {
+        typedef DynamicArray::ChannelArrays Channels;
+        typedef DynamicArray::Channel Channel;
+        typedef DynamicArray::MatchSet MatchSet;
+        static const char *name() { return "array"; }
+
+        // The permutation the sort applies, taken only when the sort runs more than once
+        class SavedOrder
+        {
+        public:
+            explicit SavedOrder(const Channel &channel) : order(nullptr)
+            {
+                const Transaction *rows = channel.rows.data;
+                if (sortRunsRepeat()) order = locationOrder(channel.rows.size, [rows](int i) { return rows[i].location; });
+            }
+            ~SavedOrder() { delete[] order; }
+            void restore(Channel &channel) const { DynamicArray::unsort(channel.rows, order); }
+
+        private:
+            int *order;
+            SavedOrder(const SavedOrder &);
+            SavedOrder &operator=(const SavedOrder &);
+        };
+
+        static bool load(const string &path, Channels &channels, CsvLoader::LoadStats &stats)
+        {
+            return DynamicArray::readCSV(path, channels, stats);
+        }
+        static int rows(const Channel &channel) { return channel.rows.size; }
+        static MatchSet search(const Channel &channel, const string &type)
+        {
+            return DynamicArray::searchByTransactionType(channel.types, type);
+        }
+        static int matchCount(const Channel &, const MatchSet &matches, const string &) { return matches.size(); }
+        static void sort(Channel &channel) { DynamicArray::sortByLocation(channel.rows); }
+        // Rebuild the index (positions moved) and measure again after a sort
+        static void reindex(Channel &channel)
+        {
+            DynamicArray::buildTypeIndex(channel.rows, channel.types);
+            channel.memory = DynamicArray::calculateMemoryUsage(channel.rows);
+        }
+        static void exportSearch(const Channel &channel, const MatchSet &matches, const string &type, const Timing::Stats &timing)
+        {
+            DynamicArray::exportSearchResultsToJson(channel.rows, matches, type, timing, channel.memory);
+        }
+        static void exportSort(const Channel &channel, const Timing::Stats &timing)
+        {
+            DynamicArray::exportSortResultsToJson(channel.rows, timing, channel.memory);
+        }
+        static void cleanup(Channels &channels) { DynamicArray::cleanup(channels); }
+    };
+
+    struct ColumnStores
+    {
+        typedef Columnar::ChannelColumns Channels;
+        typedef Columnar::Channel Channel;
+        typedef Columnar::MatchSet MatchSet;
+        static const char *name() { return "columnar"; }
+
+        // The permutation the sort applies, taken only when the sort runs more than once
+        class SavedOrder
+        {
+        public:
+            explicit SavedOrder(const Channel &channel) : order(nullptr)
+            {
+                const Categories::Code *location = channel.store.location;
+                if (sortRunsRepeat()) order = locationOrder(channel.store.size, [location](int i) { return location[i]; });
+            }
+            ~SavedOrder() { delete[] order; }
+            void restore(Channel &channel) const { Columnar::unsort(channel.store, order); }
+
+        private:
+            int *order;
+            SavedOrder(const SavedOrder &);
+            SavedOrder &operator=(const SavedOrder &);
+        };
+
+        static bool load(const string &path, Channels &channels, CsvLoader::LoadStats &stats)
+        {
+            return Columnar::readCSV(path, channels, stats);
+        }
+        static int rows(const Channel &channel) { return channel.store.size; }
+        static MatchSet search(const Channel &channel, const string &type)
+        {
+            return Columnar::searchByTransactionType(channel.indexes, type);
+        }
+        // The bitmap's cardinality, so the count does not depend on the match set
+        static int matchCount(const Channel &channel, const MatchSet &, const string &type)
+        {
+            return Columnar::countByTransactionType(channel.indexes, type);
+        }
+        static void sort(Channel &channel) { Columnar::mergeSortByLocation(channel.store); }
+        // Rebuild the indexes (positions moved) and measure again after a sort
+        static void reindex(Channel &channel)
+        {
+            Columnar::buildIndexes(channel.store, channel.indexes);
+            channel.memory = Columnar::calculateMemoryUsage(channel.store, channel.indexes);
+        }
+        static void exportSearch(const Channel &channel, const MatchSet &matches, const string &type, const Timing::Stats &timing)
+        {
+            Columnar::exportSearchResultsToJson(channel.store, matches, type, timing, channel.memory);
+        }
+        static void exportSort(const Channel &channel, const Timing::Stats &timing)
+        {
+            Columnar::exportSortResultsToJson(channel.store, timing, channel.memory);
+        }
+        static void cleanup(Channels &channels) { Columnar::cleanup(channels); }
+    };
+
+    // Time the transaction type search of one channel
+    template <typename Backend>
+    Timing::Stats timeSearch(const typename Backend::Channel &channel, const string &type,
+                             typename Backend::MatchSet &matches, long long *runsNs = nullptr)
+    {
+        return Timing::measure([](int) {}, [&]() { matches = Backend::search(channel, type); },
+                               Timing::warmupRuns, Timing::measuredRuns, runsNs);
+    }
+
+    // Time the location sort of one channel, each run sorting the original order, then
+    // reindex and measure the sorted channel
+    template <typename Backend>
+    Timing::Stats timeSort(typename Backend::Channel &channel, long long *runsNs = nullptr)
+    {
+        Timing::Stats timing;
+        {
+            typename Backend::SavedOrder original(channel);
+            timing = Timing::measure([&](int run) { if (run > 0) original.restore(channel); },
+                                     [&]() { Backend::sort(channel); },
+                                     Timing::warmupRuns, Timing::measuredRuns, runsNs);
+        }
+        Backend::reindex(channel);
+        return timing;
+    }
+}
+
+//==================================================================================
+// VECTORIZED FILTER KERNELS
+//==================================================================================
+
+// Predicate tests over a whole column that produce a bitmap, one bit per row: bit i % 64
+// of word i / 64 belongs to row i. Range kernels test lo <= value <= hi (NaN never
+// passes); the AVX2 ones compare 8 doubles or 16 floats per step. Each result word
+// replaces the bitmap word or is ANDed into it, optionally inverted.
+
+namespace FilterKernels {
+    enum Combine { SET, SET_NOT, AND, AND_NOT };
+
+    inline int bitmapWords(int rows) { return (rows + 63) / 64; }
+
+    inline void store(uint64_t *bits, int w, uint64_t word, Combine how)
+    {
+        switch (how)
+        {
+            case SET: bits[w] = word; break;
+            case SET_NOT: bits[w] = ~word; break;
+            case AND: bits[w] &= word; break;
+            default: bits[w] &= ~word; break;
+        }
+    }
+
+    // Scalar bitmap of any per-value test, also used for the rows after the last full
+    // word of the vector kernels
+    template <typename T, typename Test>
+    void testBitmap(const T *column, int size, Test test, uint64_t *bits, Combine how)
+    {
+        for (int w = 0, i = 0; i < size; ++w, i += 64)
+        {
+            int count = size - i < 64 ? size - i : 64;
+            uint64_t word = 0;
+            for (int b = 0; b < count; ++b) word |= static_cast<uint64_t>(test(column[i + b]) ? 1 : 0) << b;
+            store(bits, w, word, how);
+        }
+    }
+
+    template <typename T>
+    void rangeScalar(const T *column, int size, T lo, T hi, uint64_t *bits, Combine how)
+    {
+        testBitmap(column, size, [lo, hi](T v) { return v >= lo && v <= hi; }, bits, how);
+    }
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define FRAUD_HAS_SIMD_KERNELS
+    // AVX2: two 4-lane compares give 8 bits per step, 8 steps per word
+    __attribute__((target("avx2")))
+    void rangeDoubleAVX2(const double *column, int size, double lo, double hi, uint64_t *bits, Combine how)
+    {
+        const __m256d low = _mm256_set1_pd(lo), high = _mm256_set1_pd(hi);
+        int full = size / 64;
+        for (int w = 0; w < full; ++w)
+        {
+            const double *p = column + static_cast<size_t>(w) * 64;
+            uint64_t word = 0;
+            for (int k = 0; k < 8; ++k, p += 8)
+            {
+                __m256d a = _mm256_loadu_pd(p), b = _mm256_loadu_pd(p + 4);
+                __m256d inA = _mm256_and_pd(_mm256_cmp_pd(a, low, _CMP_GE_OQ), _mm256_cmp_pd(a, high, _CMP_LE_OQ));
+                __m256d inB = _mm256_and_pd(_mm256_cmp_pd(b, low, _CMP_GE_OQ), _mm256_cmp_pd(b, high, _CMP_LE_OQ));
+                unsigned byte = static_cast<unsigned>(_mm256_movemask_pd(inA) | (_mm256_movemask_pd(inB) << 4));
+                word |= static_cast<uint64_t>(byte) << (8 * k);
+            }
+            store(bits, w, word, how);
+        }
+        int done = full * 64;
+        if (done < size) rangeScalar(column + done, size - done, lo, hi, bits + full, how);
+    }
+
+    // AVX2: two 8-lane compares give 16 bits per step, 4 steps per word
+    __attribute__((target("avx2")))
+    void rangeFloatAVX2(const float *column, int size, float lo, float hi, uint64_t *bits, Combine how)
+    {
+        const __m256 low = _mm256_set1_ps(lo), high = _mm256_set1_ps(hi);
+        int full = size / 64;
+        for (int w = 0; w < full; ++w)
+        {
+            const float *p = column + static_cast<size_t>(w) * 64;
+            uint64_t word = 0;
+            for (int k = 0; k < 4; ++k, p += 16)
+            {
+                __m256 a = _mm256_loadu_ps(p), b = _mm256_loadu_ps(p + 8);
+                __m256 inA = _mm256_and_ps(_mm256_cmp_ps(a, low, _CMP_GE_OQ), _mm256_cmp_ps(a, high, _CMP_LE_OQ));
+                __m256 inB = _mm256_and_ps(_mm256_cmp_ps(b, low, _CMP_GE_OQ), _mm256_cmp_ps(b, high, _CMP_LE_OQ));
+                unsigned half = static_cast<unsigned>(_mm256_movemask_ps(inA) | (_mm256_movemask_ps(inB) << 8));
+                word |= static_cast<uint64_t>(half) << (16 * k);
+            }
+            store(bits, w, word, how);
+        }
+        int done = full * 64;
+        if (done < size) rangeScalar(column + done, size - done, lo, hi, bits + full, how);
+    }
+#endif
+
+    typedef void (*DoubleRangeFunction)(const double *, int, double, double, uint64_t *, Combine);
+    typedef void (*FloatRangeFunction)(const float *, int, float, float, uint64_t *, Combine);
+
+    struct Kernels
+    {
+        DoubleRangeFunction rangeDouble;
+        FloatRangeFunction rangeFloat;
+        const char *name;
+    };
+
+    // The widest kernels the CPU supports (checked via CPUID); vectorized = false picks
+    // the scalar ones, to compare against
+    Kernels select(bool vectorized)
+    {
+        Kernels k = {rangeScalar<double>, rangeScalar<float>, "scalar"};
+#ifdef FRAUD_HAS_SIMD_KERNELS
+        __builtin_cpu_init();
+        if (vectorized && __builtin_cpu_supports("avx2")) k = {rangeDoubleAVX2, rangeFloatAVX2, "AVX2"};
+#endif
+        return k;
+    }
+
+    Kernels kernels = select(true);
+
+    inline void range(const double *column, int size, double lo, double hi, uint64_t *bits, Combine how)
+    {
+        kernels.rangeDouble(column, size, lo, hi, bits, how);
+    }
+
+    inline void range(const float *column, int size, float lo, float hi, uint64_t *bits, Combine how)
+    {
+        kernels.rangeFloat(column, size, lo, hi, bits, how);
+    }
+
+    // Write the positions of the set bits among the first size rows; returns their number
+    int toPositions(const uint64_t *bits, int size, int *positions)
+    {
+        int n = 0, words = bitmapWords(size);
+        for (int w = 0; w < words; ++w)
+        {
+            uint64_t word = bits[w];
+            if (w == words - 1 && size % 64 != 0) word &= (uint64_t(1) << (size % 64)) - 1;
+            while (word != 0)
+            {
+                positions[n++] = w * 64 + __builtin_ctzll(word);
+                word &= word - 1;
+            }
+        }
+        return n;
+    }
+}
+
+//==================================================================================
+// QUERY ENGINE
+//==================================================================================
+
+// Filter expressions over the column stores, for example
+//   is_fraud && amount > 5000 && location in {Tokyo, New York} && velocity_score >= 15
+// A filter is a conjunction (&&) of predicates on single columns, evaluated one column at
+// a time. Predicates first scan whole columns into a row bitmap (numeric ones with the
+// vector kernels); once few rows are left, the bitmap becomes a selection vector of row
+// positions and each later predicate reads its column only at the selected rows and
+// compacts the vector. A payement_channel predicate picks whole channel stores instead.
+
+namespace Query {
+    enum Kind { NUMBER, CATEGORY, FLAG };
+    enum Compare { LESS, LESS_EQUAL, GREATER, GREATER_EQUAL, EQUAL, NOT_EQUAL, IN };
+
+    // A column that can be filtered on
+    struct Field
+    {
+        const char *name;
+        Kind kind;
+        int column; // Categories::Column for CATEGORY, else which numeric column
+        int width;  // Bytes read per row
+    };
+
+    const Field FIELDS[] = {
+        {"amount", NUMBER, 0, sizeof(float)},
+        {"time_since_last_transaction", NUMBER, 1, sizeof(double)},
+        {"spending_deviation_score", NUMBER, 2, sizeof(double)},
+        {"velocity_score", NUMBER, 3, sizeof(double)},
+        {"geo_anomaly_score", NUMBER, 4, sizeof(double)},
+        {"is_fraud", FLAG, 0, sizeof(bool)},
+        {"transaction_type", CATEGORY, Categories::TRANSACTION_TYPE, sizeof(Categories::Code)},
+        {"merchant_category", CATEGORY, Categories::MERCHANT_CATEGORY, sizeof(Categories::Code)},
+        {"location", CATEGORY, Categories::LOCATION, sizeof(Categories::Code)},
+        {"device_used", CATEGORY, Categories::DEVICE_USED, sizeof(Categories::Code)},
+        {"fraud_type", CATEGORY, Categories::FRAUD_TYPE, sizeof(Categories::Code)},
+        {"payement_channel", CATEGORY, Categories::PAYMENT_CHANNEL, 0},
+    };
+    const int FIELD_COUNT = sizeof(FIELDS) / sizeof(FIELDS[0]);
+    const int MAX_PREDICATES = 16;
+    const int ANY_OF = -1; // Field of a group of alternatives: ( p1 || p2 || ... )
+
+    // One condition on one column, or a group of alternatives
+    struct Predicate
+    {
+        int field; // Index into FIELDS, or ANY_OF
+        Compare compare;
+        double number;      // NUMBER: value compared against
+        bool flag;          // FLAG: value required
+        bool *accepts;      // CATEGORY: accepts[code] for each code of the column's dictionary
+        int acceptCount;
+        Predicate *alternatives; // ANY_OF: rows passing any of these pass
+        int alternativeCount;
+        double selectivity; // Estimated share of rows that pass
+        string text;        // As written, for the plan
+        Predicate()
+            : field(0), compare(EQUAL), number(0), flag(true), accepts(nullptr), acceptCount(0), alternatives(nullptr),
+              alternativeCount(0), selectivity(1) {}
+        ~Predicate()
+        {
+            delete[] accepts;
+            delete[] alternatives;
+        }
+        bool acceptsCode(Categories::Code code) const { return code < acceptCount && accepts[code]; }
+
+    private:
+        Predicate(const Predicate &);
+        Predicate &operator=(const Predicate &);
+    };
+
+    // A predicate on payement_channel, applied to whole channel stores
+    bool isChannel(const Predicate &p) { return p.field != ANY_OF && FIELDS[p.field].width == 0; }
+
+    // A predicate answered by the bitmap indexes: is_fraud, a categorical column, or a group
+    bool isIndexed(const Predicate &p) { return p.field == ANY_OF || (FIELDS[p.field].kind != NUMBER && !isChannel(p)); }
+
+    // A parsed filter expression and the order its predicates run in
+    struct Filter
+    {
+        Predicate predicates[MAX_PREDICATES];
+        int count;
+        int order[MAX_PREDICATES]; // Set by plan()
+        string text;
+        Filter() : count(0)
+        {
+            for (int i = 0; i < MAX_PREDICATES; ++i) order[i] = i;
+        }
+
+    private:
+        Filter(const Filter &);
+        Filter &operator=(const Filter &);
+    };
+
+    // Matching row positions of each channel store, indexed by channel code
+    typedef Categories::Partitions<Columnar::MatchSet> Matches;
+
+    // Reads one filter expression, left to right
+    class Parser
+    {
+    public:
+        Parser(const string &text, Filter &filter) : text(text), pos(0), filter(filter) {}
+
+        // False, with a message in error, if the expression is not valid
+        bool parse(string &error)
+        {
+            filter.text = text;
+            skipSpace();
+            if (pos == text.size())
+            {
+                error = "empty filter";
+                return false;
+            }
+            while (true)
+            {
+                if (filter.count == MAX_PREDICATES)
+                {
+                    error = "too many predicates (at most " + to_string(MAX_PREDICATES) + ")";
+                    return false;
+                }
+                size_t start = pos;
+                Predicate &p = filter.predicates[filter.count++];
+                if (!(accept("(") ? group(p, error) : predicate(p, error))) return false;
+                p.text = trim(text.substr(start, pos - start));
+                skipSpace();
+                if (pos == text.size()) return true;
+                if (!accept("&&"))
+                {
+                    error = text.compare(pos, 2, "||") == 0 ? "alternatives go in parentheses: ( a || b )"
+                                                             : "expected && at: " + text.substr(pos);
+                    return false;
+                }
+            }
+        }
+
+    private:
+        const string &text;
+        size_t pos;
+        Filter &filter;
+
+        void skipSpace()
+        {
+            while (pos < text.size() && isspace(static_cast<unsigned char>(text[pos]))) ++pos;
+        }
+
+        bool accept(const char *token)
+        {
+            skipSpace();
+            size_t length = strlen(token);
+            if (text.compare(pos, length, token) != 0) return false;
+            pos += length;
+            return true;
+        }
+
+        static string trim(const string &s)
+        {
+            size_t begin = 0, end = s.size();
+            while (begin < end && isspace(static_cast<unsigned char>(s[begin]))) ++begin;
+            while (end > begin && isspace(static_cast<unsigned char>(s[end - 1]))) --end;
+            return s.substr(begin, end - begin);
+        }
+
+        string identifier()
+        {
+            skipSpace();
+            size_t start = pos;
+            while (pos < text.size() && (isalnum(static_cast<unsigned char>(text[pos])) || text[pos] == '_')) ++pos;
+            return text.substr(start, pos - start);
+        }
+
+        // A quoted value, or bare text up to the next &&, ||, comma or closing brace or parenthesis
+        string value()
+        {
+            skipSpace();
+            if (pos < text.size() && (text[pos] == '"' || text[pos] == '\''))
+            {
+                char quote = text[pos++];
+                size_t start = pos;
+                while (pos < text.size() && text[pos] != quote) ++pos;
+                string quoted = text.substr(start, pos - start);
+                if (pos < text.size()) ++pos;
+                return quoted;
+            }
+            size_t start = pos;
+            while (pos < text.size() && text[pos] != ',' && text[pos] != '}' && text[pos] != ')' &&
+                   text.compare(pos, 2, "&&") != 0 && text.compare(pos, 2, "||") != 0)
+                ++pos;
+            return trim(text.substr(start, pos - start));
+        }
+
+        bool comparison(Compare &compare)
+        {
+            if (accept("<=")) compare = LESS_EQUAL;
+            else if (accept(">=")) compare = GREATER_EQUAL;
+            else if (accept("!=")) compare = NOT_EQUAL;
+            else if (accept("==") || accept("=")) compare = EQUAL;
+            else if (accept("<")) compare = LESS;
+            else if (accept(">")) compare = GREATER;
+            else return false;
+            return true;
+        }
+
+        bool predicate(Predicate &p, string &error)
+        {
+            bool negated = accept("!");
+            string name = identifier();
+            if (name == "payment_channel" || name == "channel") name = "payement_channel";
+            p.field = -1;
+            for (int f = 0; f < FIELD_COUNT; ++f)
+                if (name == FIELDS[f].name) p.field = f;
+            if (p.field < 0)
+            {
+                error = name.empty() ? "expected a column name at: " + text.substr(pos) : "unknown column: " + name;
+                return false;
+            }
+            const Field &field = FIELDS[p.field];
+            if (negated && field.kind != FLAG)
+            {
+                error = "! only applies to is_fraud";
+                return false;
+            }
+            if (field.kind == FLAG) return flagPredicate(p, negated, error);
+            if (field.kind == NUMBER) return numberPredicate(p, error);
+            return categoryPredicate(p, error);
+        }
+
+        // ( p1 || p2 || ... ) after the opening parenthesis, over is_fraud and categorical
+        // columns (the ones with bitmap indexes)
+        bool group(Predicate &p, string &error)
+        {
+            p.field = ANY_OF;
+            p.alternatives = new Predicate[MAX_PREDICATES];
+            do
+            {
+                if (p.alternativeCount == MAX_PREDICATES)
+                {
+                    error = "too many alternatives (at most " + to_string(MAX_PREDICATES) + ")";
+                    return false;
+                }
+                Predicate &alternative = p.alternatives[p.alternativeCount++];
+                if (!predicate(alternative, error)) return false;
+                if (!isIndexed(alternative))
+                {
+                    error = string("|| only combines is_fraud and categorical columns, not ") + FIELDS[alternative.field].name;
+                    return false;
+                }
+            } while (accept("||"));
+            if (!accept(")"))
+            {
+                error = "expected || or ) at: " + text.substr(pos);
+                return false;
+            }
+            return true;
+        }
+
+        // is_fraud, !is_fraud, is_fraud = true|false
+        bool flagPredicate(Predicate &p, bool negated, string &error)
+        {
+            p.flag = !negated;
+            size_t before = pos;
+            if (negated || !comparison(p.compare))
+            {
+                pos = before;
+                p.compare = EQUAL;
+                return true;
+            }
+            if (p.compare != EQUAL && p.compare != NOT_EQUAL)
+            {
+                error = "is_fraud only supports = and !=";
+                return false;
+            }
+            string v = value();
+            if (v == "true" || v == "1") p.flag = true;
+            else if (v == "false" || v == "0") p.flag = false;
+            else
+            {
+                error = "is_fraud compares with true or false, not: " + v;
+                return false;
+            }
+            if (p.compare == NOT_EQUAL) p.flag = !p.flag;
+            p.compare = EQUAL;
+            return true;
+        }
+
+        bool numberPredicate(Predicate &p, string &error)
+        {
+            if (!comparison(p.compare))
+            {
+                error = string("expected <, <=, >, >=, = or != after ") + FIELDS[p.field].name;
+                return false;
+            }
+            string v = value();
+            const char *end = v.data() + v.size();
+            auto parsed = from_chars(v.data(), end, p.number);
+            if (v.empty() || parsed.ec != errc() || parsed.ptr != end)
+            {
+                error = "not a number: " + v;
+                return false;
+            }
+            return true;
+        }
+
+        // Read a category value and look it up like --channel does, in any case; an unknown
+        // value is an error that lists the values in the data
+        bool categoryCode(const Field &field, Categories::Code &code, string &error)
+        {
+            string v = value();
+            Categories::Column column = static_cast<Categories::Column>(field.column);
+            code = Categories::findIgnoringCase(column, v);
+            if (code != Categories::NO_CODE) return true;
+            error = string("unknown ") + field.name + " value: " + v + " (values in the data: " +
+                    Categories::valueList(column) + ")";
+            return false;
+        }
+
+        // column = v, column != v, column in {v1, v2, ...}
+        bool categoryPredicate(Predicate &p, string &error)
+        {
+            const Field &field = FIELDS[p.field];
+            const Categories::Dictionary &dictionary = Categories::dictionaries[field.column];
+            p.acceptCount = dictionary.size();
+            p.accepts = new bool[p.acceptCount > 0 ? p.acceptCount : 1];
+            for (int c = 0; c < p.acceptCount; ++c) p.accepts[c] = false;
+            if (identifierIs("in"))
+            {
+                p.compare = IN;
+                if (!accept("{"))
+                {
+                    error = string("expected { after ") + field.name + " in";
+                    return false;
+                }
+                do
+                {
+                    Categories::Code code;
+                    if (!categoryCode(field, code, error)) return false;
+                    p.accepts[code] = true;
+                } while (accept(","));
+                if (!accept("}"))
+                {
+                    error = "expected } at: " + text.substr(pos);
+                    return false;
+                }
+                return true;
+            }
+            if (!comparison(p.compare) || (p.compare != EQUAL && p.compare != NOT_EQUAL))
+            {
+                error = string("expected =, != or in after ") + field.name;
+                return false;
+            }
+            Categories::Code code;
+            if (!categoryCode(field, code, error)) return false;
+            p.accepts[code] = true;
+            if (p.compare == NOT_EQUAL)
+                for (int c = 0; c < p.acceptCount; ++c) p.accepts[c] = !p.accepts[c];
+            return true;
+        }
+
+        // Consume a keyword only if it is a whole word
+        bool identifierIs(const char *word)
+        {
+            size_t before = pos;
+            if (identifier() == word) return true;
+            pos = before;
+            return false;
+        }
+    };
+
+    bool parse(const string &text, Filter &filter, string &error)
+    {
+        Parser parser(text, filter);
+        return parser.parse(error);
+    }
+
+    // Call visit with the column a numeric field reads
+    template <typename Visit>
+    void withNumberColumn(const Columnar::ColumnStore &store, int column, Visit visit)
+    {
+        switch (column)
+        {
+            case 0: visit(store.amount); break;
+            case 1: visit(store.time_since_last_transaction); break;
+            case 2: visit(store.spending_deviation_score); break;
+            case 3: visit(store.velocity_score); break;
+            default: visit(store.geo_anomaly_score); break;
+        }
+    }
+
+    // Keep the selected rows whose value passes test. The selection is compacted in place
+    // without branching on the result, and the new count is returned.
+    template <typename T, typename Test>
+    int select(const T *column, Test test, int *selection, int n)
+    {
+        int kept = 0;
+        for (int k = 0; k < n; ++k)
+        {
+            int i = selection[k];
+            selection[kept] = i;
+            kept += test(column[i]) ? 1 : 0;
+        }
+        return kept;
+    }
+
+    // Apply one numeric predicate to the selection; the comparison is chosen once per
+    // column, outside the row loop
+    int apply(const Predicate &p, const Columnar::ColumnStore &store, int *selection, int n)
+    {
+        int kept = 0;
+        withNumberColumn(store, FIELDS[p.field].column, [&](const auto *column) {
+            typedef typename remove_const<typename remove_pointer<decltype(column)>::type>::type Value;
+            double x = static_cast<Value>(p.number); // amount compares at float precision
+            switch (p.compare)
+            {
+                case LESS: kept = select(column, [x](double v) { return v < x; }, selection, n); break;
+                case LESS_EQUAL: kept = select(column, [x](double v) { return v <= x; }, selection, n); break;
+                case GREATER: kept = select(column, [x](double v) { return v > x; }, selection, n); break;
+                case GREATER_EQUAL: kept = select(column, [x](double v) { return v >= x; }, selection, n); break;
+                case EQUAL: kept = select(column, [x](double v) { return v == x; }, selection, n); break;
+                default: kept = select(column, [x](double v) { return v != x; }, selection, n); break;
+            }
+        });
+        return kept;
+    }
+
+    // The inclusive range [lo, hi] of column values that pass a comparison with x, in the
+    // column's own precision (as apply() compares). != uses the range of = and inverts
+    // the result.
+    template <typename T>
+    void toRange(Compare compare, double x, T &lo, T &hi)
+    {
+        const T infinity = numeric_limits<T>::infinity();
+        T f = static_cast<T>(x);
+        lo = -infinity;
+        hi = infinity;
+        switch (compare)
+        {
+            case GREATER_EQUAL: lo = f; break;
+            case GREATER: lo = nextafter(f, infinity); break;
+            case LESS_EQUAL: hi = f; break;
+            case LESS: hi = nextafter(f, -infinity); break;
+            default: lo = hi = f; break;
+        }
+    }
+
+    // Test a numeric predicate on every row of the store with the range kernels, setting
+    // (first) or narrowing the bitmap
+    void scan(const Predicate &p, const Columnar::ColumnStore &store, uint64_t *bits, bool first)
+    {
+        FilterKernels::Combine how = first ? FilterKernels::SET : FilterKernels::AND;
+        if (p.compare == NOT_EQUAL) how = first ? FilterKernels::SET_NOT : FilterKernels::AND_NOT;
+        withNumberColumn(store, FIELDS[p.field].column, [&](const auto *column) {
+            typedef typename remove_const<typename remove_pointer<decltype(column)>::type>::type Value;
+            Value lo, hi;
+            toRange(p.compare, p.number, lo, hi);
+            FilterKernels::range(column, store.size, lo, hi, bits, how);
+        });
     }
-    
-    // Calculate memory usage for a linked list
-    size_t calculateMemoryUsage(Node *head)
+
+    // Whether the filter can match rows of a channel at all
+    bool acceptsChannel(const Filter &filter, int code)
     {
-        size_t memory = 0;
-        Node *current = head;
-        while (current != nullptr)
+        for (int i = 0; i < filter.count; ++i)
         {
-            memory += sizeof(Node); // Memory for the node pointer itself
-            // Note: sizeof(Transaction) doesn't account for dynamic string data.
-            // This is a simplified calculation.
-            memory += sizeof(Transaction);
-            current = current->next;
+            const Predicate &p = filter.predicates[i];
+            if (isChannel(p) && !p.acceptsCode(static_cast<Categories::Code>(code))) return false;
         }
-        return memory;
+        return true;
     }
-    
-    // Export search results to JSON
-    void exportSearchResultsToJson(Node *head, const string &type, long long timeMs, double memoryMB, size_t spaceUsed)
-    {
-        json j;
-        j["operation"] = "search";
-        j["data_structure"] = "linked_list";
-        j["search_type"] = type;
-        j["execution_time_ms"] = timeMs;
-        j["memory_usage_mb"] = memoryMB;
-        j["space_used_bytes"] = spaceUsed;
 
-        json transactions = json::array();
-        Node *current = head;
-        while (current != nullptr)
+    // Upper bound on the index bitmaps an indexed predicate reads
+    int bitmapCount(const Predicate &p)
+    {
+        if (p.field == ANY_OF)
         {
-            if (current->data.transaction_type == type)
-            {
-                json transaction;
-                transaction["id"] = current->data.id;
-                transaction["amount"] = current->data.amount;
-                transaction["location"] = current->data.location;
-                transaction["is_fraud"] = current->data.is_fraud;
-                transactions.push_back(transaction);
-            }
-            current = current->next;
+            int n = 0;
+            for (int a = 0; a < p.alternativeCount; ++a) n += bitmapCount(p.alternatives[a]);
+            return n;
         }
-        j["matches"] = transactions;
-        ofstream file("search_results_list.json");
-        file << setw(4) << j << endl;
+        return FIELDS[p.field].kind == FLAG ? 1 : p.acceptCount;
     }
 
-    // Export sort results to JSON
-    void exportSortResultsToJson(Node *head, long long timeMs, double memoryMB, size_t spaceUsed)
+    // Collect the index bitmaps whose union is the rows passing an indexed predicate
+    int collectBitmaps(const Predicate &p, const Columnar::BitmapIndexes &indexes, const Roaring::Bitmap **sets)
     {
-        json j;
-        j["operation"] = "location_sort";
-        j["data_structure"] = "linked_list";
-        j["execution_time_ms"] = timeMs;
-        j["memory_usage_mb"] = memoryMB;
-        j["space_used_bytes"] = spaceUsed;
-
-        json transactions = json::array();
-        Node *current = head;
-        while (current != nullptr)
+        if (p.field == ANY_OF)
         {
-            json transaction;
-            transaction["id"] = current->data.id;
-            transaction["location"] = current->data.location;
-            transactions.push_back(transaction);
-            current = current->next;
+            int n = 0;
+            for (int a = 0; a < p.alternativeCount; ++a) n += collectBitmaps(p.alternatives[a], indexes, sets + n);
+            return n;
         }
-        j["sorted_transactions"] = transactions;
-        ofstream file("sort_results_list.json");
-        file << setw(4) << j << endl;
-    }
-    
-    // Deallocate all nodes in the lists
-    void cleanup(ChannelLists &channels) {
-        auto deleteList = [](Node*& head) {
-            Node* current = head;
-            while (current != nullptr) {
-                Node* next = current->next;
-                delete current;
-                current = next;
-            }
-            head = nullptr;
-        };
-        deleteList(channels.card);
-        deleteList(channels.ach);
-        deleteList(channels.wire_transfer);
-        deleteList(channels.upi);
+        if (FIELDS[p.field].kind == FLAG)
+        {
+            sets[0] = &indexes.fraud.rows(p.flag ? 1 : 0);
+            return 1;
+        }
+        int n = 0;
+        const Roaring::ValueIndex &index = indexes.categories[FIELDS[p.field].column];
+        for (int code = 0; code < p.acceptCount; ++code)
+            if (p.accepts[code] && index.rows(code).cardinality() > 0) sets[n++] = &index.rows(code);
+        return n;
     }
-}
 
-
-//==================================================================================
-// ARRAY IMPLEMENTATION
-//==================================================================================
-
-namespace DynamicArray {
-
-    struct TransactionArray
+    // Rows passing an indexed predicate: one index bitmap as it is, or the union of several
+    // built in scratch
+    const Roaring::Bitmap *indexedRows(const Predicate &p, const Columnar::BitmapIndexes &indexes, Roaring::Bitmap &scratch)
     {
-        Transaction *data;
-        int size;
-        int capacity;
-        TransactionArray() : data(nullptr), size(0), capacity(0) {}
-    };
+        const Roaring::Bitmap **sets = new const Roaring::Bitmap *[bitmapCount(p) + 1];
+        int n = collectBitmaps(p, indexes, sets);
+        const Roaring::Bitmap *rows = &scratch;
+        if (n == 1) rows = sets[0];
+        else scratch = Roaring::Bitmap::unite(sets, n);
+        delete[] sets;
+        return rows;
+    }
 
-    struct ChannelArrays
-    {
-        TransactionArray card;
-        TransactionArray ach;
-        TransactionArray wire_transfer;
-        TransactionArray upi;
-    };
+    const int SAMPLE_ROWS = 1024; // Rows sampled per channel to estimate numeric selectivity
 
-    // Insert a transaction into a dynamic array, resizing if necessary
-    void insert(TransactionArray &arr, const Transaction &t)
+    // Work out each predicate's selectivity over the channels the filter reads: exactly from
+    // bitmap cardinalities for indexed predicates, on evenly spaced sample rows for numeric
+    // ones. Channel predicates run first, then indexed ones (bitmap operations that read no
+    // column), most selective first, then numeric ones ordered so that those removing the
+    // most rows per byte read run first: rank (1 - selectivity) / width, highest first.
+    void plan(Filter &filter, const Columnar::ChannelColumns &channels)
     {
-        if (arr.size >= arr.capacity)
+        double passed[MAX_PREDICATES] = {0}, seen[MAX_PREDICATES] = {0};
+        int *sample = new int[SAMPLE_ROWS];
+        for (int code = 0; code < channels.size(); ++code)
         {
-            int new_capacity = (arr.capacity == 0) ? 10 : arr.capacity * 2;
-            Transaction *new_data = new Transaction[new_capacity];
-            for (int i = 0; i < arr.size; ++i)
+            const Columnar::Channel &channel = channels[code];
+            const Columnar::ColumnStore &store = channel.store;
+            if (store.size == 0 || !acceptsChannel(filter, code)) continue;
+            int count = store.size < SAMPLE_ROWS ? store.size : SAMPLE_ROWS;
+            for (int i = 0; i < filter.count; ++i)
             {
-                new_data[i] = arr.data[i];
+                const Predicate &p = filter.predicates[i];
+                if (isChannel(p)) continue;
+                if (isIndexed(p))
+                {
+                    const Roaring::Bitmap **sets = new const Roaring::Bitmap *[bitmapCount(p) + 1];
+                    int n = collectBitmaps(p, channel.indexes, sets);
+                    double rows = 0;
+                    for (int s = 0; s < n; ++s) rows += sets[s]->cardinality(); // Alternatives may overlap
+                    delete[] sets;
+                    passed[i] += rows < store.size ? rows : store.size;
+                    seen[i] += store.size;
+                    continue;
+                }
+                for (int k = 0; k < count; ++k) sample[k] = static_cast<int>(static_cast<long long>(k) * store.size / count);
+                passed[i] += apply(p, store, sample, count);
+                seen[i] += count;
             }
-            delete[] arr.data;
-            arr.data = new_data;
-            arr.capacity = new_capacity;
         }
-        arr.data[arr.size++] = t;
-    }
-    
-    // Search by transaction type (linear search)
-    void searchByTransactionType(const TransactionArray &arr, const string &type)
-    {
-        int matchCount = 0;
-        for (int i = 0; i < arr.size; ++i)
+        delete[] sample;
+
+        double rank[MAX_PREDICATES];
+        for (int i = 0; i < filter.count; ++i)
+        {
+            Predicate &p = filter.predicates[i];
+            p.selectivity = seen[i] > 0 ? passed[i] / seen[i] : 1.0;
+            if (isChannel(p)) rank[i] = 3.0;                     // Prunes whole stores
+            else if (isIndexed(p)) rank[i] = 2.0 - p.selectivity; // Intersect the smallest sets first
+            else rank[i] = (1.0 - p.selectivity) / FIELDS[p.field].width;
+            filter.order[i] = i;
+        }
+        for (int i = 1; i < filter.count; ++i) // Insertion sort, stable for equal ranks
         {
-            if (arr.data[i].transaction_type == type)
+            int current = filter.order[i], j = i;
+            while (j > 0 && rank[filter.order[j - 1]] < rank[current])
             {
-                matchCount++;
+                filter.order[j] = filter.order[j - 1];
+                --j;
             }
+            filter.order[j] = current;
         }
-        if (matchCount == 0)
-            cout << "No transactions found with type: " << type << endl;
-        else
-            cout << matchCount << " transactions found with type: " << type << endl;
     }
 
-    // Helper to merge two sorted subarrays
-    void merge(Transaction *array, int const left, int const mid, int const right)
+    void printPlan(const Filter &filter)
     {
-        int const subArrayOne = mid - left + 1;
-        int const subArrayTwo = right - mid;
-        Transaction *leftArray = new Transaction[subArrayOne];
-        Transaction *rightArray = new Transaction[subArrayTwo];
-        for (int i = 0; i < subArrayOne; i++) leftArray[i] = array[left + i];
-        for (int j = 0; j < subArrayTwo; j++) rightArray[j] = array[mid + 1 + j];
-        auto i = 0, j = 0;
-        int k = left;
-        while (i < subArrayOne && j < subArrayTwo)
+        cout << "Plan (" << FilterKernels::kernels.name << " filter kernels):" << endl;
+        for (int i = 0; i < filter.count; ++i)
         {
-            if (leftArray[i].location <= rightArray[j].location) array[k++] = leftArray[i++];
-            else array[k++] = rightArray[j++];
+            const Predicate &p = filter.predicates[filter.order[i]];
+            cout << "  " << i + 1 << ". " << p.text;
+            if (isChannel(p))
+                cout << "  (selects channel stores)" << endl;
+            else
+                cout << "  (" << (isIndexed(p) ? "bitmap index, " : "est. ") << fixed << setprecision(1)
+                     << p.selectivity * 100 << "% of rows pass)" << endl;
         }
-        while (i < subArrayOne) array[k++] = leftArray[i++];
-        while (j < subArrayTwo) array[k++] = rightArray[j++];
-        delete[] leftArray;
-        delete[] rightArray;
+        cout.unsetf(ios::floatfield);
+        cout << setprecision(6);
     }
 
-    // Merge sort main function for an array
-    void mergeSortByLocation(Transaction *array, int const begin, int const end)
-    {
-        if (begin >= end) return;
-        int mid = begin + (end - begin) / 2;
-        mergeSortByLocation(array, begin, mid);
-        mergeSortByLocation(array, mid + 1, end);
-        merge(array, begin, mid, end);
-    }
-    
-    // Read CSV and populate the arrays
-    void readCSV(const string &filename, ChannelArrays &channels)
+    // Rows of one store that pass every predicate, in row order. Indexed predicates come
+    // first: the bitmaps of each one's accepted values are ORed together and the results
+    // ANDed, without reading any column. Numeric predicates then scan their whole column
+    // into a flat bitmap with the range kernels while the share of rows still selected is
+    // at least one per 64-byte cache line of the column (below that, reading only the
+    // selected rows touches fewer lines); a sparser selection continues as a selection
+    // vector.
+    Columnar::MatchSet evaluate(const Filter &filter, const Columnar::Channel &channel)
     {
-        ifstream file(filename);
-        if (!file.is_open()) {
-            cout << "Error: Could not open file " << filename << endl;
-            return;
-        }
-        string line;
-        getline(file, line); // Skip header
-        while (getline(file, line))
+        const Columnar::ColumnStore &store = channel.store;
+        int size = store.size;
+        Roaring::Bitmap result, scratch;
+        const Roaring::Bitmap *indexed = nullptr; // Rows passing the indexed predicates so far
+        for (int i = 0; i < filter.count; ++i)
         {
-            stringstream ss(line);
-            string token;
-            Transaction t;
-            getline(ss, t.id, ',');
-            getline(ss, t.timestamp, ',');
-            getline(ss, t.sender_account, ',');
-            getline(ss, t.reciver_amount, ',');
-            getline(ss, token, ',');
-            t.amount = token.empty() ? 0.0f : stof(token);
-            getline(ss, t.transaction_type, ',');
-            getline(ss, t.merchant_category, ',');
-            getline(ss, t.location, ',');
-            getline(ss, t.device_used, ',');
-            getline(ss, token, ',');
-            t.is_fraud = (token == "1" || token == "true");
-            getline(ss, t.fraud_type, ',');
-            getline(ss, token, ',');
-            t.time_since_last_transaction = token.empty() ? 0.0 : stod(token);
-            getline(ss, token, ',');
-            t.spending_deviation_score = token.empty() ? 0.0 : stod(token);
-            getline(ss, token, ',');
-            t.velocity_score = token.empty() ? 0.0 : stod(token);
-            getline(ss, token, ',');
-            t.geo_anomaly_score = token.empty() ? 0.0 : stod(token);
-            getline(ss, t.payement_channel, ',');
-            getline(ss, t.ip_address, ',');
-            getline(ss, t.device_hash, ',');
-
-            if (t.payement_channel == "card") insert(channels.card, t);
-            else if (t.payement_channel == "ACH") insert(channels.ach, t);
-            else if (t.payement_channel == "wire_transfer") insert(channels.wire_transfer, t);
-            else if (t.payement_channel == "UPI") insert(channels.upi, t);
-        }
-        file.close();
-    }
-    
-    // Calculate memory usage for an array based on its size
-    size_t calculateMemoryUsage(const TransactionArray &arr)
-    {
-        return static_cast<size_t>(arr.size) * sizeof(Transaction);
-    }
-    
-    // Export search results to JSON
-    void exportSearchResultsToJson(const TransactionArray &arr, const string &type, long long timeMs, double memoryMB, size_t spaceUsed)
-    {
-        json j;
-        j["operation"] = "search";
-        j["data_structure"] = "array";
-        j["search_type"] = type;
-        j["execution_time_ms"] = timeMs;
-        j["memory_usage_mb"] = memoryMB;
-        j["space_used_bytes"] = spaceUsed;
-
-        json transactions = json::array();
-        for (int i = 0; i < arr.size; ++i)
+            const Predicate &p = filter.predicates[filter.order[i]];
+            if (!isIndexed(p)) continue;
+            const Roaring::Bitmap *rows = indexedRows(p, channel.indexes, scratch);
+            if (!indexed)
+            {
+                if (rows == &scratch) result = move(scratch);
+                indexed = rows == &scratch ? &result : rows;
+            }
+            else
+            {
+                result = Roaring::Bitmap::intersect(*indexed, *rows);
+                indexed = &result;
+            }
+            if (indexed->cardinality() == 0) return Columnar::MatchSet();
+        }
+
+        int *selection = new int[size > 0 ? size : 1];
+        uint64_t *bits = nullptr; // Rows passing so far, while scanning whole columns
+        bool started = indexed != nullptr; // Some predicate has run
+        int n = 0;
+        double selected = indexed ? static_cast<double>(indexed->cardinality()) / size : 1.0; // Share of rows passing
+        for (int i = 0; i < filter.count; ++i)
         {
-            if (arr.data[i].transaction_type == type)
+            const Predicate &p = filter.predicates[filter.order[i]];
+            if (isChannel(p) || isIndexed(p)) continue;
+            int width = FIELDS[p.field].width;
+            bool vector = selected * 64 >= width;
+            if (indexed) // Continue from the index result in the form this predicate reads
+            {
+                if (vector)
+                {
+                    bits = new uint64_t[FilterKernels::bitmapWords(size) + 1];
+                    indexed->toWords(bits, size);
+                }
+                else n = indexed->toPositions(selection);
+                indexed = nullptr;
+            }
+            if (vector && (!started || bits))
             {
-                json transaction;
-                transaction["id"] = arr.data[i].id;
-                transaction["amount"] = arr.data[i].amount;
-                transaction["location"] = arr.data[i].location;
-                transaction["is_fraud"] = arr.data[i].is_fraud;
-                transactions.push_back(transaction);
+                if (!bits) bits = new uint64_t[FilterKernels::bitmapWords(size) + 1];
+                scan(p, store, bits, !started);
             }
+            else
+            {
+                if (bits)
+                {
+                    n = FilterKernels::toPositions(bits, size, selection);
+                    delete[] bits;
+                    bits = nullptr;
+                }
+                n = apply(p, store, selection, n);
+                if (n == 0) break;
+            }
+            started = true;
+            selected *= p.selectivity;
         }
-        j["matches"] = transactions;
-        ofstream file("search_results_array.json");
-        file << setw(4) << j << endl;
+        if (indexed) n = indexed->toPositions(selection);
+        else if (bits) n = FilterKernels::toPositions(bits, size, selection);
+        else if (!started) // Only channel predicates: every row matches
+            for (n = 0; n < size; ++n) selection[n] = n;
+        delete[] bits;
+        return Columnar::MatchSet::adopt(selection, n);
     }
 
-    // Export sort results to JSON
-    void exportSortResultsToJson(const TransactionArray &arr, long long timeMs, double memoryMB, size_t spaceUsed)
+    // Evaluate the filter over every channel store; returns the total number of matches
+    int run(const Filter &filter, const Columnar::ChannelColumns &channels, Matches &matches)
     {
-        json j;
-        j["operation"] = "location_sort";
-        j["data_structure"] = "array";
-        j["execution_time_ms"] = timeMs;
-        j["memory_usage_mb"] = memoryMB;
-        j["space_used_bytes"] = spaceUsed;
-
-        json transactions = json::array();
-        for (int i = 0; i < arr.size; ++i)
+        matches.clear();
+        int total = 0;
+        for (int code = 0; code < channels.size(); ++code)
         {
-            json transaction;
-            transaction["id"] = arr.data[i].id;
-            transaction["location"] = arr.data[i].location;
-            transactions.push_back(transaction);
+            Columnar::MatchSet &channelMatches = matches.partition(code);
+            if (!acceptsChannel(filter, code)) continue;
+            channelMatches = evaluate(filter, channels[code]);
+            total += channelMatches.size();
         }
-        j["sorted_transactions"] = transactions;
-        ofstream file("sort_results_array.json");
-        file << setw(4) << j << endl;
+        return total;
     }
-    
-    // Deallocate all dynamic arrays
-    void cleanup(ChannelArrays &channels)
+
+    void printMatchCounts(const Matches &matches, int total, const string &text)
+    {
+        cout << total << " transactions matched: " << text << endl;
+        for (int code = 0; code < matches.size(); ++code)
+            if (!matches[code].empty())
+                cout << "  " << Categories::name(Categories::PAYMENT_CHANNEL, static_cast<Categories::Code>(code)) << ": "
+                     << matches[code].size() << endl;
+    }
+
+    // Memory of all channel stores together
+    Memory::Usage totalMemory(const Columnar::ChannelColumns &channels)
     {
-        delete[] channels.card.data;
-        delete[] channels.ach.data;
-        delete[] channels.wire_transfer.data;
-        delete[] channels.upi.data;
+        Memory::Usage usage;
+        for (int code = 0; code < channels.size(); ++code) usage += channels[code].memory;
+        return usage;
+    }
+
+    // Export the matches of every channel, streaming only the matched rows
+    void exportResultsToJson(const Columnar::ChannelColumns &channels, const Matches &matches, const Filter &filter,
+                             const Timing::Stats &timing, const Memory::Usage &memory)
+    {
+        JsonOutput::Writer out("query_results_columnar.json");
+        out.beginObject();
+        out.field("operation", "query");
+        out.field("data_structure", "columnar");
+        out.field("query", filter.text);
+        out.key("plan");
+        out.beginArray();
+        for (int i = 0; i < filter.count; ++i) out.value(filter.predicates[filter.order[i]].text);
+        out.endArray();
+        Timing::writeJson(out, timing);
+        Memory::writeJson(out, memory);
+        out.key("matches");
+        out.beginArray();
+        for (int code = 0; code < matches.size(); ++code)
+        {
+            const string &channel = Categories::name(Categories::PAYMENT_CHANNEL, static_cast<Categories::Code>(code));
+            for (int m = 0; m < matches[code].size(); ++m)
+                Columnar::writeMatch(out, channels[code].store, matches[code][m], &channel);
+        }
+        out.endArray();
+        out.endObject();
     }
 }
 
 // --- SHARED UTILITY FUNCTIONS ---
 
+// CSV file loaded by every implementation (--input on the command line)
+string datasetPath = "financial_fraud_detection_dataset.csv";
+size_t retainedRowBytes = 0; // Loaded rows the session keeps for implementations not built yet
+
 // NEW: Robust function to get integer input from the user
 int getIntegerInput() {
     int choice;
@@ -503,91 +5323,327 @@ int getIntegerInput() {
     return choice;
 }
 
-void showPerformanceMetrics(const string &operation, long long timeMs, double memoryMB, size_t spaceUsed)
+void showPerformanceMetrics(const string &operation, const Timing::Stats &timing, const Memory::Usage &memory, const string &allocations = "")
 {
     cout << "\n+------------------------------- PERFORMANCE METRICS -------------------------------+" << endl;
     cout << "| Operation         | " << setw(60) << left << operation << "|\n";
     cout << "|-------------------+--------------------------------------------------------------|" << endl;
-    cout << "| Execution Time    | " << setw(60) << left << (to_string(timeMs) + " ms") << "|\n";
-    cout << "| Memory Usage      | " << setw(60) << left << (to_string(memoryMB) + " MB") << "|\n";
-    cout << "| Space Used        | " << setw(60) << left << (to_string(spaceUsed) + " bytes") << "|\n";
+    cout << "| Execution Time    | " << setw(60) << left << (Timing::format(timing.medianNs) + " (median)") << "|\n";
+    cout << "| Min / Mean        | " << setw(60) << left << (Timing::format(timing.minNs) + " / " + Timing::format(timing.meanNs)) << "|\n";
+    cout << "| p95 / p99         | " << setw(60) << left << (Timing::format(timing.p95Ns) + " / " + Timing::format(timing.p99Ns)) << "|\n";
+    cout << "| Std Deviation     | " << setw(60) << left << Timing::format(timing.stddevNs) << "|\n";
+    cout << "| Runs              | " << setw(60) << left
+         << (to_string(timing.runs) + " measured + " + to_string(timing.warmup) + " warm-up") << "|\n";
+    Memory::ProcessMemory process = Memory::readProcessMemory();
+    cout << "| Memory Usage      | " << setw(60) << left << (to_string(memory.totalMB()) + " MB") << "|\n";
+    cout << "| Space Used        | " << setw(60) << left << (to_string(memory.total()) + " bytes") << "|\n";
+    cout << "| Breakdown         | " << setw(60) << left << Memory::describe(memory) << "|\n";
+    if (memory.indexBytes > 0)
+        cout << "| Bitmap Indexes    | " << setw(60) << left << Memory::formatMB(memory.indexBytes) << "|\n";
+    if (retainedRowBytes > 0)
+        cout << "| Session Rows      | " << setw(60) << left
+             << (Memory::formatMB(retainedRowBytes) + " kept to build the other implementations") << "|\n";
+    cout << "| Heap (live/peak)  | " << setw(60) << left
+         << (Memory::formatMB(process.heapLiveBytes) + " / " + Memory::formatMB(process.heapPeakBytes)) << "|\n";
+    cout << "| RSS (now/peak)    | " << setw(60) << left
+         << (Memory::formatMB(process.rssBytes) + " / " + Memory::formatMB(process.peakRssBytes)) << "|\n";
+    if (!allocations.empty())
+        cout << "| Allocations       | " << setw(60) << left << allocations << "|\n";
     cout << "+----------------------------------------------------------------------------------+" << endl;
     cout << "Press Enter to continue...";
     cin.get();    // Waits for Enter key
 }
 
+// List the payment channels found in the data and ask for one; returns its dictionary
+// code, or -1 after an invalid choice
+template <typename Channels, typename RowCount>
+int selectChannel(const Channels &channels, RowCount rowsOf)
+{
+    cout << "\nSelect Payment Channel:\n";
+    for (int code = 0; code < channels.size(); ++code)
+        cout << code + 1 << ". " << Categories::name(Categories::PAYMENT_CHANNEL, static_cast<Categories::Code>(code))
+             << " (" << rowsOf(channels[code]) << " rows)\n";
+    cout << "Choice: ";
+    int choice = getIntegerInput();
+    if (choice < 1 || choice > channels.size())
+    {
+        cout << "Invalid channel selection! Returning to menu." << endl;
+        return -1;
+    }
+    return choice - 1;
+}
+
+// Ask for a thread count (0 = all cores); returns false and leaves it alone on bad input
+bool readThreadCount(const string &prompt, unsigned &threads)
+{
+    cout << prompt << " (currently " << threads << ", 1 = serial, 0 = all cores): ";
+    int value = getIntegerInput();
+    if (value < 0)
+    {
+        cout << "Invalid thread count. Keeping " << threads << "." << endl;
+        return false;
+    }
+    threads = (value == 0) ? Parallel::hardwareThreads() : static_cast<unsigned>(value);
+    return true;
+}
+
+// Choose how many worker threads the CSV loader and the array sort use
+void configureThreads()
+{
+    cout << "Hardware threads: " << Parallel::hardwareThreads() << endl;
+    readThreadCount("Loader threads", CsvLoader::loadThreads);
+    readThreadCount("Array sort threads", DynamicArray::sortThreads);
+    cout << "Loader will use " << CsvLoader::loadThreads << " thread(s), array sort will use "
+         << DynamicArray::sortThreads << " thread(s)." << endl;
+}
+
+// Choose how many unmeasured and measured runs each timed operation makes
+void configureTiming()
+{
+    cout << "Warm-up runs (currently " << Timing::warmupRuns << "): ";
+    int value = getIntegerInput();
+    if (value >= 0) Timing::warmupRuns = static_cast<unsigned>(value);
+    else cout << "Invalid count. Keeping " << Timing::warmupRuns << "." << endl;
+    cout << "Measured runs (currently " << Timing::measuredRuns << ", at least 1): ";
+    value = getIntegerInput();
+    if (value >= 1) Timing::measuredRuns = static_cast<unsigned>(value);
+    else cout << "Invalid count. Keeping " << Timing::measuredRuns << "." << endl;
+    cout << "Each operation will run " << Timing::warmupRuns << " warm-up + " << Timing::measuredRuns
+         << " measured time(s)." << endl;
+}
+
+// --- SESSION DATASET ---
+// The interactive menus share one load of the CSV: its rows, per channel and in file order.
+// Each implementation is built from them the first time its menu is opened, so switching
+// between implementations never reads the file again. Building copies the rows while other
+// implementations still need them; the last one to be built takes them over, so from then
+// on no spare copy is kept. Each implementation's channels are kept for the session;
+// everything is released and reloaded (dictionaries included) when the file's size or
+// modification time changes.
+
+namespace Session {
+    DynamicArray::ChannelArrays *rows = nullptr; // Loaded rows, until the last implementation takes them
+    bool loaded = false;
+    string loadedPath;
+    uint64_t loadedBytes = 0;
+    int64_t loadedModified = 0;
+
+    LinkedList::ChannelLists *lists = nullptr;
+    DynamicArray::ChannelArrays *arrays = nullptr;
+    Columnar::ChannelColumns *columns = nullptr;
+
+    // Free the rows and every implementation built from them
+    void release()
+    {
+        if (lists) LinkedList::cleanup(*lists);
+        if (arrays) DynamicArray::cleanup(*arrays);
+        if (columns) Columnar::cleanup(*columns);
+        if (rows) DynamicArray::cleanup(*rows);
+        delete lists;
+        delete arrays;
+        delete columns;
+        delete rows;
+        lists = nullptr;
+        arrays = nullptr;
+        columns = nullptr;
+        rows = nullptr;
+        retainedRowBytes = 0;
+        loaded = false;
+    }
+
+    // Load datasetPath unless the session's data is still current; false if the file
+    // cannot be read
+    bool load()
+    {
+        uint64_t bytes = 0;
+        int64_t modified = 0;
+        bool found = CsvLoader::sourceInfo(datasetPath, bytes, modified);
+        if (loaded && found && datasetPath == loadedPath && bytes == loadedBytes && modified == loadedModified) return true;
+        if (loaded) cout << "Dataset changed on disk, reloading..." << endl;
+        release(); // Before the load rebuilds the dictionaries the implementations' codes refer to
+
+        rows = new DynamicArray::ChannelArrays;
+        CsvLoader::LoadStats stats;
+        size_t allocationsBefore = Memory::allocationCount.load();
+        if (!CsvLoader::load(datasetPath, *rows, stats, DynamicArray::insertByChannel, DynamicArray::mergePartial,
+                             DynamicArray::reserveByChannel))
+        {
+            release();
+            return false;
+        }
+        stats.allocations = Memory::allocationCount.load() - allocationsBefore;
+        CsvLoader::printLoadStats(stats);
+        for (int code = 0; code < rows->size(); ++code)
+            retainedRowBytes += DynamicArray::calculateMemoryUsage((*rows)[code].rows).total();
+        loaded = true;
+        loadedPath = datasetPath;
+        loadedBytes = bytes;
+        loadedModified = modified;
+        return true;
+    }
+
+    // Whether the implementation being built is the last one that needs the loaded rows
+    bool buildingLast() { return (lists == nullptr) + (arrays == nullptr) + (columns == nullptr) == 1; }
+
+    // Free the loaded rows once the last implementation has been built from them
+    void dropRows()
+    {
+        DynamicArray::cleanup(*rows);
+        delete rows;
+        rows = nullptr;
+        retainedRowBytes = 0;
+    }
+
+    // Call insert with every row of one channel in file order: moved out if take is set,
+    // else copied
+    template <typename Insert>
+    void transferRows(DynamicArray::TransactionArray &from, bool take, Insert insert)
+    {
+        for (int i = 0; i < from.size; ++i)
+        {
+            if (take) insert(move(from.data[i]));
+            else insert(Transaction(from.data[i]));
+        }
+    }
+
+    void printBuilt(const char *what, bool took, chrono::steady_clock::time_point start)
+    {
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        cout << "Built " << what << (took ? " from" : " from a copy of") << " the loaded dataset in " << fixed
+             << setprecision(2) << ms << " ms" << endl;
+        cout.unsetf(ios::floatfield);
+        cout << setprecision(6);
+    }
+
+    // The linked lists, built on first use. Rows are inserted in file order, as a CSV load does.
+    LinkedList::ChannelLists *linkedLists()
+    {
+        if (lists) return lists;
+        bool take = buildingLast();
+        auto start = chrono::steady_clock::now();
+        LinkedList::ChannelLists *built = new LinkedList::ChannelLists;
+        for (int code = 0; code < rows->size(); ++code)
+        {
+            LinkedList::Channel &channel = built->partition(code);
+            size_t allocationsBefore = Memory::allocationCount.load();
+            transferRows((*rows)[code].rows, take,
+                         [&channel](Transaction &&t) { LinkedList::insert(channel.head, channel.nodes, move(t)); });
+            channel.buildAllocations = Memory::allocationCount.load() - allocationsBefore;
+        }
+        lists = built;
+        if (take) dropRows();
+        LinkedList::finishLoading(*lists);
+        printBuilt("linked lists", take, start);
+        return lists;
+    }
+
+    // The arrays, built on first use: the loaded rows themselves if no other implementation
+    // needs them any more
+    DynamicArray::ChannelArrays *dynamicArrays()
+    {
+        if (arrays) return arrays;
+        bool take = buildingLast();
+        auto start = chrono::steady_clock::now();
+        if (take)
+        {
+            arrays = rows;
+            rows = nullptr;
+            retainedRowBytes = 0;
+        }
+        else
+        {
+            arrays = new DynamicArray::ChannelArrays;
+            for (int code = 0; code < rows->size(); ++code)
+                arrays->partition(code).rows = DynamicArray::copyOf((*rows)[code].rows);
+        }
+        DynamicArray::finishLoading(*arrays);
+        printBuilt("arrays", take, start);
+        return arrays;
+    }
+
+    // The column stores, built on first use
+    Columnar::ChannelColumns *columnStores()
+    {
+        if (columns) return columns;
+        bool take = buildingLast();
+        auto start = chrono::steady_clock::now();
+        Columnar::ChannelColumns *built = new Columnar::ChannelColumns;
+        for (int code = 0; code < rows->size(); ++code)
+        {
+            Columnar::ColumnStore &store = built->partition(code).store;
+            Columnar::reserve(store, (*rows)[code].rows.size);
+            transferRows((*rows)[code].rows, take, [&store](Transaction &&t) { Columnar::insert(store, move(t)); });
+        }
+        columns = built;
+        if (take) dropRows();
+        Columnar::finishLoading(*columns);
+        printBuilt("column stores", take, start);
+        return columns;
+    }
+}
 
 // --- MAIN PROGRAM LOGIC ---
+// Ask for the transaction type to search
+string readTransactionType() {
+    cout << "Enter transaction type to search: ";
+    string type;
+    getline(cin, type);
+    return type;
+}
+
 void runLinkedListImplementation() {
-    LinkedList::ChannelLists channels;
-    cout << "Loading data into Linked Lists..." << endl;
-    LinkedList::readCSV("financial_fraud_detection_dataset.csv", channels);
+    if (!Session::load()) return;
+    LinkedList::ChannelLists &channels = *Session::linkedLists();
 
     while (true) {
         cout << "\n--- Linked List Menu ---" << endl;
         cout << "1. Search by Transaction Type" << endl;
         cout << "2. Sort Transactions by Location" << endl;
+        cout << "3. Compare Sorts (Recursive vs Bottom-Up)" << endl;
         cout << "0. Back to Main Menu" << endl;
         cout << "Enter your choice: ";
         int choice = getIntegerInput();
         
         if (choice == 0) break;
         
-        // This block will only execute for valid menu options (1 or 2)
-        if (choice == 1 || choice == 2) {
-            cout << "\nSelect Payment Channel:\n1. Card\n2. ACH\n3. Wire Transfer\n4. UPI\nChoice: ";
-            int channelChoice = getIntegerInput();
-
-            LinkedList::Node* selectedChannel = nullptr;
-            switch (channelChoice) {
-                case 1: selectedChannel = channels.card; break;
-                case 2: selectedChannel = channels.ach; break;
-                case 3: selectedChannel = channels.wire_transfer; break;
-                case 4: selectedChannel = channels.upi; break;
-                default: cout << "Invalid channel selection! Returning to menu." << endl; continue;
-            }
-            
-            if (!selectedChannel) {
+        // This block will only execute for valid menu options (1, 2 or 3)
+        if (choice >= 1 && choice <= 3) {
+            int channelCode = selectChannel(channels, [](const LinkedList::Channel &c) { return c.nodes.nodes(); });
+            if (channelCode < 0) continue;
+
+            LinkedList::Channel &channel = channels[channelCode];
+            if (!channel.head) {
                 cout << "Channel is empty or invalid!" << endl;
                 continue;
             }
 
             if (choice == 1) {
-                cout << "Enter transaction type to search: ";
-                string type;
-                getline(cin, type);
-                auto start = chrono::high_resolution_clock::now();
-                LinkedList::searchByTransactionType(selectedChannel, type);
-                auto end = chrono::high_resolution_clock::now();
-                auto duration = chrono::duration_cast<chrono::milliseconds>(end - start);
-                size_t mem = LinkedList::calculateMemoryUsage(selectedChannel);
-                double memMB = static_cast<double>(mem) / (1024 * 1024);
-                LinkedList::exportSearchResultsToJson(selectedChannel, type, duration.count(), memMB, mem);
-                showPerformanceMetrics("Search (Linked List)", duration.count(), memMB, mem);
+                string type = readTransactionType();
+                LinkedList::MatchSet matches;
+                Timing::Stats timing = Backends::timeSearch<Backends::LinkedLists>(channel, type, matches);
+                Index::printMatchCount(matches.size(), type);
+                Backends::LinkedLists::exportSearch(channel, matches, type, timing);
+                showPerformanceMetrics("Search (Linked List)", timing, channel.memory,
+                                       LinkedList::describeAllocations(channel));
             } else if (choice == 2) {
-                auto start = chrono::high_resolution_clock::now();
-                if (channelChoice == 1) channels.card = LinkedList::mergeSortByLocation(selectedChannel);
-                else if (channelChoice == 2) channels.ach = LinkedList::mergeSortByLocation(selectedChannel);
-                else if (channelChoice == 3) channels.wire_transfer = LinkedList::mergeSortByLocation(selectedChannel);
-                else if (channelChoice == 4) channels.upi = LinkedList::mergeSortByLocation(selectedChannel);
-                auto end = chrono::high_resolution_clock::now();
-                auto duration = chrono::duration_cast<chrono::milliseconds>(end - start);
-                size_t mem = LinkedList::calculateMemoryUsage(selectedChannel);
-                double memMB = static_cast<double>(mem) / (1024 * 1024);
-                LinkedList::exportSortResultsToJson(selectedChannel, duration.count(), memMB, mem);
-                showPerformanceMetrics("Sort (Linked List)", duration.count(), memMB, mem);
+                Timing::Stats timing = Backends::timeSort<Backends::LinkedLists>(channel);
+                Backends::LinkedLists::exportSort(channel, timing);
+                showPerformanceMetrics("Sort (Linked List)", timing, channel.memory,
+                                       LinkedList::describeAllocations(channel));
+            } else if (choice == 3) {
+                LinkedList::compareSortAlgorithms(channel.head);
+                cout << "Press Enter to continue...";
+                cin.get();
             }
         } else {
             cout << "Invalid choice. Please try again." << endl;
         }
     }
-    LinkedList::cleanup(channels);
 }
 
 void runArrayImplementation() {
-    DynamicArray::ChannelArrays channels;
-    cout << "Loading data into Arrays..." << endl;
-    DynamicArray::readCSV("financial_fraud_detection_dataset.csv", channels);
+    if (!Session::load()) return;
+    DynamicArray::ChannelArrays &channels = *Session::dynamicArrays();
 
     while (true) {
         cout << "\n--- Array Menu ---" << endl;
@@ -600,61 +5656,412 @@ void runArrayImplementation() {
         if (choice == 0) break;
         
         if (choice == 1 || choice == 2) {
-            cout << "\nSelect Payment Channel:\n1. Card\n2. ACH\n3. Wire Transfer\n4. UPI\nChoice: ";
-            int channelChoice = getIntegerInput();
-            
-            DynamicArray::TransactionArray* selectedChannel = nullptr;
-            switch(channelChoice) {
-                case 1: selectedChannel = &channels.card; break;
-                case 2: selectedChannel = &channels.ach; break;
-                case 3: selectedChannel = &channels.wire_transfer; break;
-                case 4: selectedChannel = &channels.upi; break;
-                default: cout << "Invalid channel selection! Returning to menu." << endl; continue;
-            }
-
-            if (!selectedChannel || selectedChannel->size == 0) {
+            int channelCode = selectChannel(channels, [](const DynamicArray::Channel &c) { return c.rows.size; });
+            if (channelCode < 0) continue;
+
+            DynamicArray::Channel &channel = channels[channelCode];
+            if (channel.rows.size == 0) {
+                cout << "Channel is empty or invalid!" << endl;
+                continue;
+            }
+
+            if (choice == 1) {
+                string type = readTransactionType();
+                DynamicArray::MatchSet matches;
+                Timing::Stats timing = Backends::timeSearch<Backends::DynamicArrays>(channel, type, matches);
+                Index::printMatchCount(matches.size(), type);
+                Backends::DynamicArrays::exportSearch(channel, matches, type, timing);
+                showPerformanceMetrics("Search (Array)", timing, channel.memory);
+            } else if (choice == 2) {
+                Timing::Stats timing = Backends::timeSort<Backends::DynamicArrays>(channel);
+                Backends::DynamicArrays::exportSort(channel, timing);
+                showPerformanceMetrics("Sort (Array, " + to_string(DynamicArray::sortThreads) + " thread(s))",
+                                       timing, channel.memory);
+            }
+        } else {
+            cout << "Invalid choice. Please try again." << endl;
+        }
+    }
+}
+
+// Read a filter expression, run it over every channel store and export the matches
+void runQuery(const Columnar::ChannelColumns &channels) {
+    cout << "Filter, e.g. is_fraud && amount > 5000 && location in {Tokyo, New York}" << endl;
+    cout << "Columns: amount, time_since_last_transaction, spending_deviation_score, velocity_score," << endl;
+    cout << "  geo_anomaly_score (< <= > >= = !=), is_fraud, transaction_type, merchant_category," << endl;
+    cout << "  location, device_used, fraud_type, payement_channel (= != in {...})" << endl;
+    cout << "Enter filter: ";
+    string text;
+    getline(cin, text);
+    Query::Filter filter;
+    string error;
+    if (!Query::parse(text, filter, error)) {
+        cout << "Invalid filter: " << error << endl;
+        return;
+    }
+    Query::plan(filter, channels);
+    Query::printPlan(filter);
+    Query::Matches matches;
+    int total = 0;
+    Timing::Stats timing = Timing::measure([](int) {}, [&]() { total = Query::run(filter, channels, matches); });
+    Query::printMatchCounts(matches, total, filter.text);
+    Memory::Usage memory = Query::totalMemory(channels);
+    Query::exportResultsToJson(channels, matches, filter, timing, memory);
+    showPerformanceMetrics("Query (Columnar, all channels)", timing, memory);
+}
+
+void runColumnarImplementation() {
+    if (!Session::load()) return;
+    Columnar::ChannelColumns &channels = *Session::columnStores();
+
+    while (true) {
+        cout << "\n--- Columnar Store Menu ---" << endl;
+        cout << "1. Search by Transaction Type" << endl;
+        cout << "2. Sort Transactions by Location" << endl;
+        cout << "3. Query All Channels (filter expression)" << endl;
+        cout << "0. Back to Main Menu" << endl;
+        cout << "Enter your choice: ";
+        int choice = getIntegerInput();
+        
+        if (choice == 0) break;
+        
+        if (choice == 3) {
+            runQuery(channels);
+        } else if (choice == 1 || choice == 2) {
+            int channelCode = selectChannel(channels, [](const Columnar::Channel &c) { return c.store.size; });
+            if (channelCode < 0) continue;
+
+            Columnar::Channel &channel = channels[channelCode];
+            if (channel.store.size == 0) {
                 cout << "Channel is empty or invalid!" << endl;
                 continue;
             }
 
             if (choice == 1) {
-                cout << "Enter transaction type to search: ";
-                string type;
-                getline(cin, type);
-                auto start = chrono::high_resolution_clock::now();
-                DynamicArray::searchByTransactionType(*selectedChannel, type);
-                auto end = chrono::high_resolution_clock::now();
-                auto duration = chrono::duration_cast<chrono::milliseconds>(end - start);
-                size_t mem = DynamicArray::calculateMemoryUsage(*selectedChannel);
-                double memMB = static_cast<double>(mem) / (1024 * 1024);
-                DynamicArray::exportSearchResultsToJson(*selectedChannel, type, duration.count(), memMB, mem);
-                showPerformanceMetrics("Search (Array)", duration.count(), memMB, mem);
+                string type = readTransactionType();
+                Columnar::MatchSet matches;
+                Timing::Stats timing = Backends::timeSearch<Backends::ColumnStores>(channel, type, matches);
+                Index::printMatchCount(Backends::ColumnStores::matchCount(channel, matches, type), type);
+                Backends::ColumnStores::exportSearch(channel, matches, type, timing);
+                showPerformanceMetrics("Search (Columnar)", timing, channel.memory);
             } else if (choice == 2) {
-                auto start = chrono::high_resolution_clock::now();
-                DynamicArray::mergeSortByLocation(selectedChannel->data, 0, selectedChannel->size - 1);
-                auto end = chrono::high_resolution_clock::now();
-                auto duration = chrono::duration_cast<chrono::milliseconds>(end - start);
-                size_t mem = DynamicArray::calculateMemoryUsage(*selectedChannel);
-                double memMB = static_cast<double>(mem) / (1024 * 1024);
-                DynamicArray::exportSortResultsToJson(*selectedChannel, duration.count(), memMB, mem);
-                showPerformanceMetrics("Sort (Array)", duration.count(), memMB, mem);
+                Timing::Stats timing = Backends::timeSort<Backends::ColumnStores>(channel);
+                Backends::ColumnStores::exportSort(channel, timing);
+                showPerformanceMetrics("Sort (Columnar)", timing, channel.memory);
             }
         } else {
             cout << "Invalid choice. Please try again." << endl;
         }
     }
-    DynamicArray::cleanup(channels);
+}
+
+// --- BATCH MODE ---
+// Runs one operation without any prompts and writes the metrics as JSON, e.g.
+//   ./fraud --ds=array --op=sort --channel=card --input=file.csv --repeat=5
+// Console messages go to stderr so the metrics can be piped from stdout.
+
+struct BatchOptions
+{
+    string ds;
+    string op;
+    string channel;
+    string type;
+    string where; // Filter expression of --op=query
+    string metricsPath;
+    bool exportResults;
+    Generator::Config generator; // rows > 0: write a synthetic dataset instead
+    string outputPath;
+    BatchOptions() : ds("array"), channel("card"), type("transfer"), metricsPath("-"), exportResults(true), outputPath("synthetic.csv") {}
+};
+
+// Timings and sizes collected by one batch run
+struct BatchResult
+{
+    CsvLoader::LoadStats load;
+    Timing::Stats timing;
+    long long *runsNs; // Measured runs in run order
+    int channelRows; // Rows the operation read (every channel the filter reads for queries)
+    int matches;     // -1 for sorts
+    Memory::Usage memory;
+    Memory::ProcessMemory process; // Sampled before the channels are freed
+    size_t indexBytes[Columnar::BitmapIndexes::COUNT]; // Columnar: bytes of each bitmap index
+    BatchResult() : runsNs(new long long[Timing::measuredRuns]), channelRows(0), matches(-1)
+    {
+        for (int i = 0; i < Columnar::BitmapIndexes::COUNT; ++i) indexBytes[i] = 0;
+    }
+    ~BatchResult() { delete[] runsNs; }
+
+    void addIndexBytes(const Columnar::BitmapIndexes &indexes)
+    {
+        for (int i = 0; i < Columnar::BitmapIndexes::COUNT; ++i) indexBytes[i] += indexes.index(i).bytes();
+    }
+};
+
+void printUsage()
+{
+    cerr << "Usage: fraud [options]\n"
+         << "  --ds=list|array|columnar      data structure (default array)\n"
+         << "  --op=search|sort|query        run one operation without menus\n"
+         << "  --channel=NAME                payment channel, any case (default card)\n"
+         << "  --type=NAME                   transaction type to search (default transfer)\n"
+         << "  --where=FILTER                filter of --op=query, over all channels of the columnar\n"
+         << "                                store, e.g. \"is_fraud && amount > 5000 && location in {Tokyo}\"\n"
+         << "  --input=FILE                  CSV to load (default " << datasetPath << ")\n"
+         << "  --repeat=N                    measured runs (default " << Timing::measuredRuns << ")\n"
+         << "  --warmup=N                    unmeasured runs first (default " << Timing::warmupRuns << ")\n"
+         << "  --metrics=FILE                write the metrics JSON here (default stdout)\n"
+         << "  --threads=N                   loader threads (0 = all cores)\n"
+         << "  --sort-threads=N              array sort threads (0 = all cores)\n"
+         << "  --scalar-filters              evaluate query ranges without the AVX2 kernels\n"
+         << "  --compact                     write compact JSON\n"
+         << "  --no-export                   skip the search/sort result files\n"
+         << "  --no-snapshot                 always parse the CSV, never read or write a snapshot\n"
+         << "  --generate=ROWS               write a synthetic dataset (e.g. 10M) and exit\n"
+         << "  --output=FILE                 where --generate writes (default synthetic.csv)\n";
+    Generator::printOptions(cerr);
+    cerr << "Without --op or --generate the interactive menus start." << endl;
+}
+
+// Parse a non-negative integer option value
+bool parseCount(const string &text, int &value)
+{
+    const char *end = text.data() + text.size();
+    auto parsed = from_chars(text.data(), end, value);
+    return !text.empty() && parsed.ec == errc() && parsed.ptr == end && value >= 0;
+}
+
+// Read --key=value options. Settings that also exist in the menus are applied directly.
+bool parseOptions(int argc, char **argv, BatchOptions &options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        size_t equals = arg.find('=');
+        string key = arg.substr(0, equals);
+        string value = equals == string::npos ? "" : arg.substr(equals + 1);
+        int count = 0;
+        bool valid = true;
+        if (Generator::parseOption(key, value, options.generator, valid))
+        {
+            if (valid) continue;
+            cerr << "Invalid value: " << arg << endl;
+            return false;
+        }
+        if (key == "--ds") options.ds = value;
+        else if (key == "--op") options.op = value;
+        else if (key == "--channel") options.channel = value;
+        else if (key == "--type") options.type = value;
+        else if (key == "--where") options.where = value;
+        else if (key == "--input") datasetPath = value;
+        else if (key == "--metrics") options.metricsPath = value;
+        else if (key == "--generate" && Generator::parseRows(value, options.generator.rows)) {}
+        else if (key == "--output") options.outputPath = value;
+        else if (key == "--repeat" && parseCount(value, count) && count > 0) Timing::measuredRuns = count;
+        else if (key == "--warmup" && parseCount(value, count)) Timing::warmupRuns = count;
+        else if (key == "--threads" && parseCount(value, count))
+            CsvLoader::loadThreads = count == 0 ? Parallel::hardwareThreads() : static_cast<unsigned>(count);
+        else if (key == "--sort-threads" && parseCount(value, count))
+            DynamicArray::sortThreads = count == 0 ? Parallel::hardwareThreads() : static_cast<unsigned>(count);
+        else if (arg == "--compact") JsonOutput::prettyPrint = false;
+        else if (arg == "--no-export") options.exportResults = false;
+        else if (arg == "--no-snapshot") CsvLoader::useSnapshots = false;
+        else if (arg == "--scalar-filters") FilterKernels::kernels = FilterKernels::select(false);
+        else
+        {
+            cerr << "Unknown or invalid option: " << arg << endl;
+            return false;
+        }
+    }
+    if (options.ds == "linked_list") options.ds = "list";
+    if (options.ds != "list" && options.ds != "array" && options.ds != "columnar")
+    {
+        cerr << "Unknown data structure: " << options.ds << endl;
+        return false;
+    }
+    if (!options.op.empty() && options.op != "search" && options.op != "sort" && options.op != "query")
+    {
+        cerr << "Unknown operation: " << options.op << endl;
+        return false;
+    }
+    if (options.op == "query")
+    {
+        if (options.where.empty())
+        {
+            cerr << "--op=query needs --where=FILTER" << endl;
+            return false;
+        }
+        options.ds = "columnar"; // Queries run on the column stores
+    }
+    return true;
+}
+
+// Dictionary code of a payment channel name (case-insensitive) among the loaded channels;
+// -1, after listing the channels there are, if none matches
+int findChannel(const string &channel, int channelCount)
+{
+    Categories::Code code = Categories::findIgnoringCase(Categories::PAYMENT_CHANNEL, channel);
+    if (code != Categories::NO_CODE && code < channelCount) return code;
+    cerr << "Unknown channel: " << channel << " (channels in the data: "
+         << Categories::valueList(Categories::PAYMENT_CHANNEL) << ")" << endl;
+    return -1;
+}
+
+// Bytes of each bitmap index of the channel; only the column stores have them
+template <typename Channel>
+void addIndexBytes(BatchResult &, const Channel &) {}
+void addIndexBytes(BatchResult &result, const Columnar::Channel &channel) { result.addIndexBytes(channel.indexes); }
+
+// Search or sort one channel of any data structure
+template <typename Backend>
+bool runChannelBatch(const BatchOptions &options, BatchResult &result)
+{
+    typename Backend::Channels channels;
+    if (!Backend::load(datasetPath, channels, result.load)) return false;
+    int code = findChannel(options.channel, channels.size());
+    if (code < 0)
+    {
+        Backend::cleanup(channels);
+        return false;
+    }
+    typename Backend::Channel &channel = channels[code];
+    result.channelRows = Backend::rows(channel);
+    if (options.op == "search")
+    {
+        typename Backend::MatchSet matches;
+        result.timing = Backends::timeSearch<Backend>(channel, options.type, matches, result.runsNs);
+        result.matches = Backend::matchCount(channel, matches, options.type);
+        Index::printMatchCount(result.matches, options.type);
+        if (options.exportResults) Backend::exportSearch(channel, matches, options.type, result.timing);
+    }
+    else
+    {
+        result.timing = Backends::timeSort<Backend>(channel, result.runsNs);
+        if (options.exportResults) Backend::exportSort(channel, result.timing);
+    }
+    result.memory = channel.memory;
+    addIndexBytes(result, channel);
+    result.process = Memory::readProcessMemory();
+    Backend::cleanup(channels);
+    return true;
+}
+
+bool runQueryBatch(const BatchOptions &options, BatchResult &result)
+{
+    Columnar::ChannelColumns channels;
+    if (!Columnar::readCSV(datasetPath, channels, result.load)) return false;
+    Query::Filter filter;
+    string error;
+    if (!Query::parse(options.where, filter, error))
+    {
+        cerr << "Invalid filter: " << error << endl;
+        Columnar::cleanup(channels);
+        return false;
+    }
+    Query::plan(filter, channels);
+    Query::printPlan(filter);
+    for (int code = 0; code < channels.size(); ++code)
+    {
+        if (Query::acceptsChannel(filter, code)) result.channelRows += channels[code].store.size;
+        result.addIndexBytes(channels[code].indexes); // Like result.memory, over every channel
+    }
+    result.memory = Query::totalMemory(channels);
+    Query::Matches matches;
+    result.timing = Timing::measure([](int) {}, [&]() { result.matches = Query::run(filter, channels, matches); },
+                                    Timing::warmupRuns, Timing::measuredRuns, result.runsNs);
+    Query::printMatchCounts(matches, result.matches, filter.text);
+    if (options.exportResults) Query::exportResultsToJson(channels, matches, filter, result.timing, result.memory);
+    result.process = Memory::readProcessMemory();
+    Columnar::cleanup(channels);
+    return true;
+}
+
+// Write the metrics of a batch run as one JSON object
+void writeBatchMetrics(const BatchOptions &options, const BatchResult &result)
+{
+    JsonOutput::Writer out(options.metricsPath.c_str());
+    out.beginObject();
+    out.field("data_structure", options.ds);
+    out.field("operation", options.op);
+    if (options.op == "query") out.field("query", options.where);
+    else out.field("channel", options.channel);
+    if (options.op == "search") out.field("search_type", options.type);
+    out.field("input", datasetPath);
+    out.field("load_source", result.load.fromSnapshot ? "snapshot" : "csv");
+    out.field("load_ms", result.load.seconds * 1000.0);
+    out.field("load_threads", result.load.threads);
+    out.field("load_allocations", result.load.allocations);
+    out.field("rows_loaded", result.load.rows);
+    out.field("channel_rows", result.channelRows);
+    if (result.matches >= 0) out.field("matches", result.matches);
+    if (options.ds == "array" && options.op == "sort") out.field("sort_threads", static_cast<int>(DynamicArray::sortThreads));
+    Timing::writeJson(out, result.timing);
+    out.key("runs_ns");
+    out.beginArray();
+    for (int i = 0; i < result.timing.runs; ++i) out.value(result.runsNs[i]);
+    out.endArray();
+    Memory::writeJson(out, result.memory, result.process);
+    if (options.ds == "columnar" || options.op == "query")
+    {
+        out.key("bitmap_index_bytes");
+        out.beginObject();
+        for (int i = 0; i < Columnar::BitmapIndexes::COUNT; ++i)
+            out.field(Columnar::BitmapIndexes::name(i), result.indexBytes[i]);
+        out.endObject();
+    }
+    out.endObject();
+}
+
+// Run the operation chosen on the command line; returns the process exit code
+int runBatch(const BatchOptions &options)
+{
+    streambuf *console = cout.rdbuf(cerr.rdbuf()); // Keep stdout for the metrics
+    BatchResult result;
+    bool ok = options.op == "query" ? runQueryBatch(options, result)
+              : options.ds == "list"  ? runChannelBatch<Backends::LinkedLists>(options, result)
+              : options.ds == "array" ? runChannelBatch<Backends::DynamicArrays>(options, result)
+                                      : runChannelBatch<Backends::ColumnStores>(options, result);
+    cout.rdbuf(console);
+    if (!ok) return 1;
+    writeBatchMetrics(options, result);
+    return 0;
 }
 
 
-int main()
+// benchmark.cpp includes this file with FRAUD_NO_MAIN defined and supplies its own main
+#ifndef FRAUD_NO_MAIN
+int main(int argc, char **argv)
 {
+    BatchOptions options;
+    if (argc > 1 && (strcmp(argv[1], "--help") == 0 || strcmp(argv[1], "-h") == 0))
+    {
+        printUsage();
+        return 0;
+    }
+    if (!parseOptions(argc, argv, options))
+    {
+        printUsage();
+        return 2;
+    }
+    if (options.generator.rows > 0)
+    {
+        Generator::Stats stats;
+        options.generator.threads = CsvLoader::loadThreads; // The output is the same for any thread count
+        if (!Generator::generate(options.generator, options.outputPath, stats)) return 1;
+        Generator::printStats(stats, options.outputPath);
+        return 0;
+    }
+    if (!options.op.empty()) return runBatch(options);
+
     while (true)
     {
         cout << "\n+-------------------- MAIN MENU ------------------+" << endl;
         cout << "| Select the data structure to use:               |" << endl;
         cout << "| 1. Linked List Implementation                   |" << endl;
         cout << "| 2. Array Implementation                         |" << endl;
+        cout << "| 3. Columnar Store Implementation                |" << endl;
+        cout << "| 4. Thread Settings                              |" << endl;
+        cout << "| 5. Toggle JSON Output (" << (JsonOutput::prettyPrint ? "indented -> compact)     " : "compact -> indented)     ") << "|" << endl;
+        cout << "| 6. Timing Settings (warm-up / measured runs)    |" << endl;
         cout << "| 0. Exit Program                                 |" << endl;
         cout << "+-------------------------------------------------+" << endl;
         cout << "Enter your choice: ";
@@ -669,7 +6076,21 @@ int main()
         case 2:
             runArrayImplementation();
             break;
+        case 3:
+            runColumnarImplementation();
+            break;
+        case 4:
+            configureThreads();
+            break;
+        case 5:
+            JsonOutput::prettyPrint = !JsonOutput::prettyPrint;
+            cout << "JSON exports will be " << (JsonOutput::prettyPrint ? "indented." : "compact.") << endl;
+            break;
+        case 6:
+            configureTiming();
+            break;
         case 0:
+            Session::release();
             cout << "Exiting program. Goodbye!" << endl;
             return 0;
         default:
@@ -680,3 +6101,4 @@ int main()
 
     return 0;
 }
+#endif